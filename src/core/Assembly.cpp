@@ -0,0 +1,126 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <cctype>
+#include <map>
+#include <set>
+#include <sstream>
+#include "../include/Assembly.h"
+
+static const std::set<std::string> twoByteInstructions = {
+		"MVI", "ADI", "ACI", "SUI", "SBI", "ANI", "XRI", "ORI", "CPI", "IN", "OUT"
+};
+
+static const std::set<std::string> threeByteInstructions = {
+		"LXI", "LDA", "STA", "LHLD", "SHLD", "JMP", "JZ", "JNZ", "JC", "JNC", "JP", "JM", "JPE", "JPO",
+		"CALL", "CZ", "CNZ", "CC", "CNC", "CP", "CM", "CPE", "CPO"
+};
+
+static const std::set<std::string> directives = {"ORG", "END", "EQU"};
+
+// T-states of the register forms, the memory forms are listed below
+static const std::map<std::string, size_t> instructionCycleTable = {
+		{"MOV", 5}, {"MVI", 7}, {"LXI", 10}, {"LDA", 13}, {"STA", 13}, {"LHLD", 16}, {"SHLD", 16},
+		{"LDAX", 7}, {"STAX", 7}, {"XCHG", 4}, {"XTHL", 18}, {"SPHL", 5}, {"PCHL", 5},
+		{"ADD", 4}, {"ADC", 4}, {"SUB", 4}, {"SBB", 4}, {"ANA", 4}, {"XRA", 4}, {"ORA", 4}, {"CMP", 4},
+		{"ADI", 7}, {"ACI", 7}, {"SUI", 7}, {"SBI", 7}, {"ANI", 7}, {"XRI", 7}, {"ORI", 7}, {"CPI", 7},
+		{"INR", 5}, {"DCR", 5}, {"INX", 5}, {"DCX", 5}, {"DAD", 10}, {"DAA", 4},
+		{"RLC", 4}, {"RRC", 4}, {"RAL", 4}, {"RAR", 4}, {"CMA", 4}, {"CMC", 4}, {"STC", 4},
+		{"JMP", 10}, {"JZ", 10}, {"JNZ", 10}, {"JC", 10}, {"JNC", 10}, {"JP", 10}, {"JM", 10}, {"JPE", 10},
+		{"JPO", 10}, {"CALL", 17}, {"CZ", 17}, {"CNZ", 17}, {"CC", 17}, {"CNC", 17}, {"CP", 17}, {"CM", 17},
+		{"CPE", 17}, {"CPO", 17}, {"RET", 10}, {"RZ", 11}, {"RNZ", 11}, {"RC", 11}, {"RNC", 11}, {"RP", 11},
+		{"RM", 11}, {"RPE", 11}, {"RPO", 11}, {"RST", 11},
+		{"PUSH", 11}, {"POP", 10}, {"IN", 10}, {"OUT", 10}, {"EI", 4}, {"DI", 4}, {"HLT", 7}, {"NOP", 4}
+};
+
+static const std::map<std::string, size_t> memoryCycleTable = {
+		{"MOV", 7}, {"MVI", 10}, {"INR", 10}, {"DCR", 10},
+		{"ADD", 7}, {"ADC", 7}, {"SUB", 7}, {"SBB", 7}, {"ANA", 7}, {"XRA", 7}, {"ORA", 7}, {"CMP", 7}
+};
+
+Assembly::Instruction Assembly::parse(const std::string& line) {
+	Instruction instruction;
+	size_t end = 0;
+	for (bool quoted = false; end < line.size() && (quoted || line[end] != ';'); end++) {
+		if (line[end] == '\'') quoted = !quoted;
+	}
+	std::string text = line.substr(0, end);
+	auto colon = text.find(':');
+	if (colon != std::string::npos) text = text.substr(colon + 1);
+	std::istringstream iss(text);
+	if (!(iss >> instruction.mnemonic) || directives.count(instruction.mnemonic)) return {};
+	std::string operand;
+	while (std::getline(iss >> std::ws, operand, ',')) {
+		while (!operand.empty() && isspace(operand.back())) operand.pop_back();
+		instruction.operands.push_back(operand);
+	}
+	return instruction;
+}
+
+size_t Assembly::instructionSize(const std::string& line) {
+	// one line of the emitted 8080 code, labels and comments take no space
+	size_t end = 0;
+	for (bool quoted = false; end < line.size() && (quoted || line[end] != ';'); end++) {
+		if (line[end] == '\'') quoted = !quoted;
+	}
+	std::string text = line.substr(0, end);
+	auto colon = text.find(':');
+	if (colon != std::string::npos) text = text.substr(colon + 1);
+	std::istringstream iss(text);
+	std::string mnemonic;
+	if (!(iss >> mnemonic) || directives.count(mnemonic)) return 0;
+	if (mnemonic == "DB" || mnemonic == "DW") {
+		// items are separated by commas, a quoted item is one byte per character
+		size_t bytes = 0;
+		std::string rest;
+		std::getline(iss, rest);
+		bool quoted = false;
+		bool item = false;
+		for (char c : rest) {
+			if (c == '\'') {
+				quoted = !quoted;
+			} else if (quoted) {
+				bytes++;
+			} else if (c == ',') {
+				if (item) bytes += mnemonic == "DW" ? 2 : 1;
+				item = false;
+			} else if (!isspace(c)) {
+				item = true;
+			}
+		}
+		if (item) bytes += mnemonic == "DW" ? 2 : 1;
+		return bytes;
+	}
+	if (threeByteInstructions.count(mnemonic)) return 3;
+	if (twoByteInstructions.count(mnemonic)) return 2;
+	return 1;
+}
+
+size_t Assembly::instructionCycles(const std::string& line) {
+	auto instruction = parse(line);
+	auto it = instructionCycleTable.find(instruction.mnemonic);
+	if (it == instructionCycleTable.end()) return 0;
+	for (const auto& operand : instruction.operands) {
+		if (operand == "M" && memoryCycleTable.count(instruction.mnemonic)) {
+			return memoryCycleTable.at(instruction.mnemonic);
+		}
+	}
+	return it->second;
+}
+
+size_t Assembly::cycles(const std::string& code) {
+	std::istringstream iss(code);
+	std::string line;
+	size_t cycles = 0;
+	while (std::getline(iss, line)) cycles += instructionCycles(line);
+	return cycles;
+}
+
+size_t Assembly::size(const std::string& code) {
+	std::istringstream iss(code);
+	std::string line;
+	size_t bytes = 0;
+	while (std::getline(iss, line)) bytes += instructionSize(line);
+	return bytes;
+}
@@ -4,6 +4,7 @@
 
 #include "../include/Atoms.h"
 #include "../include/Translator.h"
+#include <algorithm>
 #include <iostream>
 
 #include "../include/StringTable.h"
@@ -69,6 +70,10 @@ void NumberOperand::load(std::ostream& stream, int) const {
 	stream << "MVI A, " + std::to_string(this->_value) + "\n";
 }
 
+int NumberOperand::value() const noexcept {
+	return this->_value;
+}
+
 StringOperand::StringOperand(size_t index, const StringTable *stringTable) : _index(index),
                                                                              _stringTable(stringTable) {}
 
@@ -80,6 +85,10 @@ std::string StringOperand::toString() const {
 	}
 }
 
+size_t StringOperand::index() const noexcept {
+	return this->_index;
+}
+
 LabelOperand::LabelOperand(int labelId) : _labelId(labelId) {}
 
 std::string LabelOperand::toString() const {
@@ -90,12 +99,32 @@ std::string LabelOperand::toString() const {
 	}
 }
 
+int LabelOperand::labelId() const noexcept {
+	return this->_labelId;
+}
+
 bool LabelOperand::operator>=(const LabelOperand& rhs) const {
 	return this->_labelId >= rhs._labelId;
 }
 
 Atom::Atom() = default;
 
+size_t Atom::line() const noexcept {
+	return _line;
+}
+
+void Atom::setLine(size_t line) {
+	_line = line;
+}
+
+std::vector<std::shared_ptr<RValue>> Atom::uses() const {
+	return {};
+}
+
+std::shared_ptr<MemoryOperand> Atom::def() const {
+	return nullptr;
+}
+
 BinaryOpAtom::BinaryOpAtom(std::string name,
                            std::shared_ptr<RValue> left,
                            std::shared_ptr<RValue> right,
@@ -120,21 +149,68 @@ void BinaryOpAtom::generate(std::ostream& stream, Translator *translator, int sc
 	}
 	_left->load(stream, 0);
 	if (_name == "MUL") {
-		stream << "CALL @MULT\n";
+		stream << translator->callHelper("@MULT");
 		stream << "MOV A, C\n";
 	} else if (_name == "DIV") {
-		stream << "CALL @DIV\n";
+		stream << translator->callHelper("@DIV");
 		stream << "MOV A, C\n";
 	} else if (_name == "AND") {
 		stream << "ANA B\n";
 	} else if (_name == "OR") {
 		stream << "ORA B\n";
+	} else if (_name == "EQ" || _name == "NE") {
+		// 0/1 without jumps: A - B is zero only when equal, SUI 1 borrows only from zero
+		// and ADI 255 carries from anything else, SBB A spreads the carry over A
+		stream << "SUB B\n";
+		stream << (_name == "EQ" ? "SUI 1\n" : "ADI 255\n");
+		stream << "SBB A\n";
+		stream << "ANI 1\n";
+	} else if (_name == "LT" || _name == "GE") {
+		// the sign of A - B, the flag JM tests
+		stream << "SUB B\n";
+		stream << "RLC\n";
+		stream << "ANI 1\n";
+		if (_name == "GE") stream << "XRI 1\n";
+	} else if (_name == "LE" || _name == "GT") {
+		// a zero difference is turned into 0FFH before its sign is taken
+		stream << "SUB B\n";
+		stream << "MOV C, A\n";
+		stream << "SUI 1\n";
+		stream << "SBB A\n";
+		stream << "ORA C\n";
+		stream << "RLC\n";
+		stream << "ANI 1\n";
+		if (_name == "GT") stream << "XRI 1\n";
 	} else {
 		stream << _name + " B\n";
 	}
 	_result->save(stream);
 }
 
+std::vector<std::shared_ptr<RValue>> BinaryOpAtom::uses() const {
+	return {_left, _right};
+}
+
+std::shared_ptr<MemoryOperand> BinaryOpAtom::def() const {
+	return _result;
+}
+
+const std::string& BinaryOpAtom::name() const noexcept {
+	return _name;
+}
+
+const std::shared_ptr<RValue>& BinaryOpAtom::left() const noexcept {
+	return _left;
+}
+
+const std::shared_ptr<RValue>& BinaryOpAtom::right() const noexcept {
+	return _right;
+}
+
+const std::shared_ptr<MemoryOperand>& BinaryOpAtom::result() const noexcept {
+	return _result;
+}
+
 UnaryOpAtom::UnaryOpAtom(std::string name,
                          std::shared_ptr<RValue> operand,
                          std::shared_ptr<MemoryOperand> result) : _name(std::move(name)),
@@ -165,6 +241,26 @@ void UnaryOpAtom::generate(std::ostream& stream, Translator *translator, int sco
 	}
 }
 
+std::vector<std::shared_ptr<RValue>> UnaryOpAtom::uses() const {
+	return {_operand};
+}
+
+std::shared_ptr<MemoryOperand> UnaryOpAtom::def() const {
+	return _result;
+}
+
+const std::string& UnaryOpAtom::name() const noexcept {
+	return _name;
+}
+
+const std::shared_ptr<RValue>& UnaryOpAtom::operand() const noexcept {
+	return _operand;
+}
+
+const std::shared_ptr<MemoryOperand>& UnaryOpAtom::result() const noexcept {
+	return _result;
+}
+
 OutAtom::OutAtom(std::shared_ptr<Operand> value) : _value(std::move(value)) {}
 
 std::string OutAtom::toString() const {
@@ -177,7 +273,7 @@ void OutAtom::generate(std::ostream& stream, Translator *translator, int scope)
 		std::string buf;
 		for (auto x : _value->toString()) if (x != 'S') buf += x;
 		stream << "LXI H, str" + buf + "\n";
-		stream << "CALL @PRINT\n";
+		stream << translator->callHelper("@PRINT");
 		return;
 	}
 	if (_value->toString()[0] == '`') {
@@ -189,6 +285,18 @@ void OutAtom::generate(std::ostream& stream, Translator *translator, int scope)
     stream << "OUT 1\n";
 }
 
+std::vector<std::shared_ptr<RValue>> OutAtom::uses() const {
+	auto value = std::dynamic_pointer_cast<RValue>(_value);
+	if (value) {
+		return {value};
+	}
+	return {};
+}
+
+const std::shared_ptr<Operand>& OutAtom::value() const noexcept {
+	return _value;
+}
+
 InAtom::InAtom(std::shared_ptr<MemoryOperand> result) : _result(std::move(result)) {}
 
 std::string InAtom::toString() const {
@@ -201,6 +309,14 @@ void InAtom::generate(std::ostream& stream, Translator *translator, int scope) c
 	_result->save(stream);
 }
 
+std::shared_ptr<MemoryOperand> InAtom::def() const {
+	return _result;
+}
+
+const std::shared_ptr<MemoryOperand>& InAtom::result() const noexcept {
+	return _result;
+}
+
 LabelAtom::LabelAtom(std::shared_ptr<LabelOperand> label) : _label(std::move(label)) {}
 
 std::string LabelAtom::toString() const {
@@ -212,6 +328,10 @@ void LabelAtom::generate(std::ostream& stream, Translator *translator, int scope
 	stream << "LBL" + _label->toString() + ":\n";
 }
 
+const std::shared_ptr<LabelOperand>& LabelAtom::label() const noexcept {
+	return _label;
+}
+
 JumpAtom::JumpAtom(std::shared_ptr<LabelOperand> label) : _label(std::move(label)) {}
 
 std::string JumpAtom::toString() const {
@@ -223,6 +343,10 @@ void JumpAtom::generate(std::ostream& stream, Translator *translator, int scope)
 	stream << "JMP LBL" + _label->toString() + "\n";
 }
 
+const std::shared_ptr<LabelOperand>& JumpAtom::label() const noexcept {
+	return _label;
+}
+
 ConditionalJumpAtom::ConditionalJumpAtom(std::string condition,
                                          std::shared_ptr<RValue> left,
                                          std::shared_ptr<RValue> right,
@@ -244,20 +368,23 @@ ConditionalJumpAtom::generate(std::ostream& stream, Translator *translator, int
 	stream << "MOV B, A\n";
 	_left->load(stream, 0);
 	stream << "CMP B\n";
+	// several GT/GE jumps may share a target, each needs its own skip label
+	int skipCount = translator->codeGenSkipLabels[_label->labelId()]++;
+	std::string skip = "LBL" + _label->toString() + "A" + (skipCount ? std::to_string(skipCount) : "");
 	if (_condition == "EQ") {
 		stream << "JZ LBL" << _label->toString() << '\n';
 	} else if (_condition == "NE") {
 		stream << "JNZ LBL" << _label->toString() << '\n';
 	} else if (_condition == "GT") {
-		stream << "JM LBL" << _label->toString() << "A\n";
+		stream << "JM " << skip << "\n";
 		stream << "JNZ LBL" << _label->toString() << '\n';
-		stream << "LBL" << _label->toString() << "A:\n";
+		stream << skip << ":\n";
 	} else if (_condition == "LT") {
 		stream << "JM LBL" << _label->toString() << '\n';
 	} else if (_condition == "GE") {
-		stream << "JM LBL" << _label->toString() << "A\n";
+		stream << "JM " << skip << "\n";
 		stream << "JMP LBL" << _label->toString() << '\n';
-		stream << "LBL" << _label->toString() << "A:\n";
+		stream << skip << ":\n";
 	} else if (_condition == "LE") {
 		stream << "JM LBL" << _label->toString() << '\n';
 		stream << "JZ LBL" << _label->toString() << '\n';
@@ -266,6 +393,216 @@ ConditionalJumpAtom::generate(std::ostream& stream, Translator *translator, int
 	}
 }
 
+std::vector<std::shared_ptr<RValue>> ConditionalJumpAtom::uses() const {
+	return {_left, _right};
+}
+
+std::string ConditionalJumpAtom::invertCondition(const std::string& condition) {
+	if (condition == "EQ") return "NE";
+	if (condition == "NE") return "EQ";
+	if (condition == "LT") return "GE";
+	if (condition == "GE") return "LT";
+	if (condition == "GT") return "LE";
+	if (condition == "LE") return "GT";
+	throw CodeGenerationException("Unexpected condition " + condition);
+}
+
+const std::string& ConditionalJumpAtom::condition() const noexcept {
+	return _condition;
+}
+
+const std::shared_ptr<RValue>& ConditionalJumpAtom::left() const noexcept {
+	return _left;
+}
+
+const std::shared_ptr<RValue>& ConditionalJumpAtom::right() const noexcept {
+	return _right;
+}
+
+const std::shared_ptr<LabelOperand>& ConditionalJumpAtom::label() const noexcept {
+	return _label;
+}
+
+SwitchAtom::SwitchAtom(std::shared_ptr<RValue> value, const Cases& cases,
+                       std::shared_ptr<LabelOperand> defaultLabel) : _value(std::move(value)),
+                                                                     _default(std::move(defaultLabel)) {
+	// values compare as bytes, the first of equal cases wins; kept sorted as unsigned bytes
+	for (const auto& c : cases) {
+		int byte = c.first & 0xFF;
+		bool duplicate = false;
+		for (const auto& existing : _cases) {
+			duplicate = duplicate || existing.first == byte;
+		}
+		if (!duplicate) _cases.emplace_back(byte, c.second);
+	}
+	std::sort(_cases.begin(), _cases.end(), [](const Cases::value_type& a, const Cases::value_type& b) {
+		return a.first < b.first;
+	});
+}
+
+std::string SwitchAtom::toString() const {
+	std::string cases;
+	for (const auto& c : _cases) {
+		cases += (cases.empty() ? "" : " ") + std::to_string(c.first) + ":" + c.second->toString();
+	}
+	return "(SWITCH, " + _value->toString() + ", " + cases + ", " + _default->toString() + ")";
+}
+
+static void searchTreeCost(size_t n, size_t& bytes, size_t& cycles) {
+	// mirrors generateSearchTree: up to three cases are compared in a row
+	if (n <= 3) {
+		bytes = 5 * n + 3;
+		cycles = 17 * (n + 1) / 2 + 10;
+		return;
+	}
+	size_t leftBytes, leftCycles, rightBytes, rightCycles;
+	searchTreeCost(n / 2, leftBytes, leftCycles);
+	searchTreeCost(n - n / 2 - 1, rightBytes, rightCycles);
+	bytes = 8 + leftBytes + rightBytes;
+	cycles = 27 + std::max(leftCycles, rightCycles);
+}
+
+SwitchAtom::Lowering SwitchAtom::chooseLowering(const Cases& cases, bool forSize) {
+	// rough 8080 bytes and cycles of each dispatch once the value is in A
+	size_t n = cases.size();
+	if (n == 0) return Lowering::linear;
+	// the jump table is indexed by the value minus the smallest case, as a signed byte
+	int low = 127, high = -128;
+	for (const auto& c : cases) {
+		int value = c.first >= 0x80 ? c.first - 0x100 : c.first;
+		low = std::min(low, value);
+		high = std::max(high, value);
+	}
+	size_t range = size_t(high - low + 1);
+	// (CPI k) (JZ L) per case, then (JMP default)
+	size_t linearBytes = 5 * n + 3, linearCycles = 17 * (n + 1) / 2 + 10;
+	// (CPI k) (JZ L) (JC lower) per node
+	size_t treeBytes, treeCycles;
+	searchTreeCost(n, treeBytes, treeCycles);
+	// range check, address arithmetic, PCHL and a DW per value in range
+	size_t tableBytes = 20 + 2 * range, tableCycles = 94;
+	auto cost = [forSize](size_t bytes, size_t cycles) { return forSize ? bytes : bytes + cycles; };
+	size_t linear = cost(linearBytes, linearCycles);
+	size_t tree = cost(treeBytes, treeCycles);
+	size_t table = cost(tableBytes, tableCycles);
+	if (linear <= tree && linear <= table) return Lowering::linear;
+	return tree <= table ? Lowering::searchTree : Lowering::jumpTable;
+}
+
+void SwitchAtom::generateLinear(std::ostream& stream, size_t from, size_t to) const {
+	for (size_t i = from; i < to; i++) {
+		stream << "CPI " << _cases[i].first << '\n';
+		stream << "JZ LBL" << _cases[i].second->toString() << '\n';
+	}
+	stream << "JMP LBL" << _default->toString() << '\n';
+}
+
+void SwitchAtom::generateSearchTree(std::ostream& stream, const std::string& name, size_t from, size_t to,
+                                    size_t& nodes) const {
+	// unsigned compares: CPI sets the carry when A is below the operand
+	if (to - from <= 3) {
+		generateLinear(stream, from, to);
+		return;
+	}
+	size_t middle = (from + to) / 2;
+	std::string lower = name + "L" + std::to_string(nodes++);
+	stream << "CPI " << _cases[middle].first << '\n';
+	stream << "JZ LBL" << _cases[middle].second->toString() << '\n';
+	stream << "JC " << lower << '\n';
+	generateSearchTree(stream, name, middle + 1, to, nodes);
+	stream << lower << ":\n";
+	generateSearchTree(stream, name, from, middle, nodes);
+}
+
+void SwitchAtom::generateJumpTable(std::ostream& stream, const std::string& name) const {
+	int low = 127, high = -128;
+	for (const auto& c : _cases) {
+		int value = c.first >= 0x80 ? c.first - 0x100 : c.first;
+		low = std::min(low, value);
+		high = std::max(high, value);
+	}
+	int range = high - low + 1;
+	if (low != 0) stream << "SUI " << (low & 0xFF) << '\n';
+	if (range < 0x100) {
+		stream << "CPI " << range << '\n';
+		stream << "JNC LBL" << _default->toString() << '\n';
+	}
+	stream << "LXI H, " << name << '\n';
+	stream << "MOV E, A\n";
+	stream << "MVI D, 0\n";
+	stream << "DAD D\n";
+	stream << "DAD D\n";
+	stream << "MOV E, M\n";
+	stream << "INX H\n";
+	stream << "MOV D, M\n";
+	stream << "XCHG\n";
+	stream << "PCHL\n";
+	stream << name << ":\n";
+	for (int value = low; value <= high; value++) {
+		stream << "DW LBL" << target(value)->toString() << '\n';
+	}
+}
+
+void SwitchAtom::generate(std::ostream& stream, Translator *translator, int scope) const {
+	stream << "\t; " + toString() + "\n";
+	_value->load(stream, 0);
+	std::string name = "SWT" + std::to_string(translator->codeGenSwitchCount++);
+	switch (chooseLowering(_cases, GlobalParameters::getInstance().optimizeForSize)) {
+		case Lowering::linear:
+			generateLinear(stream, 0, _cases.size());
+			break;
+		case Lowering::searchTree: {
+			size_t nodes = 0;
+			generateSearchTree(stream, name, 0, _cases.size(), nodes);
+			break;
+		}
+		case Lowering::jumpTable:
+			generateJumpTable(stream, name);
+			break;
+	}
+}
+
+std::vector<std::shared_ptr<RValue>> SwitchAtom::uses() const {
+	return {_value};
+}
+
+const std::shared_ptr<LabelOperand>& SwitchAtom::target(int value) const {
+	for (const auto& c : _cases) {
+		if (c.first == (value & 0xFF)) return c.second;
+	}
+	return _default;
+}
+
+std::vector<std::shared_ptr<LabelOperand>> SwitchAtom::labels() const {
+	std::vector<std::shared_ptr<LabelOperand>> out;
+	for (const auto& c : _cases) out.push_back(c.second);
+	out.push_back(_default);
+	return out;
+}
+
+std::shared_ptr<SwitchAtom>
+SwitchAtom::retarget(const std::map<int, std::shared_ptr<LabelOperand>>& labels) const {
+	auto rename = [&labels](const std::shared_ptr<LabelOperand>& label) {
+		auto it = labels.find(label->labelId());
+		return it == labels.end() ? label : it->second;
+	};
+	Cases cases;
+	for (const auto& c : _cases) cases.emplace_back(c.first, rename(c.second));
+	return std::make_shared<SwitchAtom>(_value, cases, rename(_default));
+}
+
+const std::shared_ptr<RValue>& SwitchAtom::value() const noexcept {
+	return _value;
+}
+
+const SwitchAtom::Cases& SwitchAtom::cases() const noexcept {
+	return _cases;
+}
+
+const std::shared_ptr<LabelOperand>& SwitchAtom::defaultLabel() const noexcept {
+	return _default;
+}
+
 CallAtom::CallAtom(std::shared_ptr<MemoryOperand> function,
                    std::shared_ptr<MemoryOperand> result) : _function(std::move(function)),
                                                             _result(std::move(result)) {}
@@ -288,8 +625,9 @@ void CallAtom::generate(std::ostream& stream, Translator *translator, int scope)
 			throw CodeGenerationException("Not enough arguments for CALL: expected " +
 			                              std::to_string(n) + ", got " + std::to_string(i));
 		}
+		// four saved register pairs, the result slot and the arguments pushed so far
 		stream << "LXI B, 0\n";
-		param->load(stream, 12 + 2 * i);
+		param->load(stream, 10 + 2 * i);
 		stream << "MOV C, A\n";
 		stream << "PUSH B\n";
 	}
@@ -298,9 +636,10 @@ void CallAtom::generate(std::ostream& stream, Translator *translator, int scope)
 	for (int i = 0; i < n; i++) {
 		stream << "POP B\n";
 	}
+	// the callee stores the result into the low byte of its slot, only the saved registers are left
 	stream << "POP B\n";
-	stream << "MOV A, B\n";
-	_result->save(stream, 10);
+	stream << "MOV A, C\n";
+	_result->save(stream, 8);
 	loadRegs(stream);
 }
 
@@ -312,6 +651,67 @@ void CallAtom::loadRegs(std::ostream& stream) {
 	stream << "POP PSW\nPOP H\nPOP D\nPOP B\n";
 }
 
+std::shared_ptr<MemoryOperand> CallAtom::def() const {
+	return _result;
+}
+
+const std::shared_ptr<MemoryOperand>& CallAtom::function() const noexcept {
+	return _function;
+}
+
+const std::shared_ptr<MemoryOperand>& CallAtom::result() const noexcept {
+	return _result;
+}
+
+static void releaseFrame(std::ostream& stream, const SymbolTable& table, int scope) {
+	// a byte frame is dropped at once, SPHL keeps A and the flags
+	if (!GlobalParameters::getInstance().byteFrames) {
+		for (size_t i = 0; i < table.getM(scope); i++) stream << "POP B\n";
+	} else if (table.getFrameSize(scope) > 0) {
+		stream << "LXI H, " + std::to_string(table.getFrameSize(scope)) + "\n";
+		stream << "DAD SP\n";
+		stream << "SPHL\n";
+	}
+}
+
+TailCallAtom::TailCallAtom(std::shared_ptr<MemoryOperand> function) : _function(std::move(function)) {}
+
+std::string TailCallAtom::toString() const {
+	return "(TAILCALL, " + _function->toString() + ",,)";
+}
+
+void TailCallAtom::generate(std::ostream& stream, Translator *translator, int scope) const {
+	// the callee takes over the frame: its arguments replace ours, our locals are dropped
+	// and the callee returns straight to our caller, into our result slot
+	stream << "\t; " + toString() + "\n";
+	const SymbolTable& table = translator->getSymbolTable();
+	int n = table._records[_function->index()]._len;
+	if (n != table._records[scope]._len) {
+		throw CodeGenerationException("TAILCALL to a function with another number of parameters");
+	}
+	auto frame = table.getFrameSize(scope);
+	auto& vector = translator->codeGenFuncArgs;
+	for (int i = 0; i < n; ++i) {
+		auto param = vector[vector.size() - (n - i)];
+		param->load(stream, 2 * i);
+		stream << "MOV C, A\n";
+		stream << "PUSH B\n";
+	}
+	vector.erase(vector.end() - n, vector.end());
+	for (int i = n - 1; i >= 0; i--) {
+		stream << "POP B\n";
+		stream << "LXI H, " + std::to_string(frame + 2 * n) + "\n";
+		stream << "DAD SP\n";
+		stream << "MOV M, C\n";
+	}
+	releaseFrame(stream, table, scope);
+	stream << "JMP " + table._records[_function->index()]._name + "\n";
+}
+
+const std::shared_ptr<MemoryOperand>& TailCallAtom::function() const noexcept {
+	return _function;
+}
+
 RetAtom::RetAtom(std::shared_ptr<RValue> value) : _value(std::move(value)) {}
 
 std::string RetAtom::toString() const {
@@ -321,16 +721,23 @@ std::string RetAtom::toString() const {
 void RetAtom::generate(std::ostream& stream, Translator *translator, int scope) const {
 	stream << "\t; " + toString() + "\n";
 	const SymbolTable& table = translator->getSymbolTable();
-	auto m = table.getM(scope);
-	auto res = 2 * (m + table._records[scope]._len + 1);
+	auto res = table.getFrameSize(scope) + 2 * (table._records[scope]._len + 1);
 	_value->load(stream, 0);
 	stream << "LXI H, " + std::to_string(res) + "\n";
 	stream << "DAD SP\n";
 	stream << "MOV M, A\n";
-	for (int i = 0; i < m; i++) stream << "POP B\n";
+	releaseFrame(stream, table, scope);
 	stream << "RET\n";
 }
 
+std::vector<std::shared_ptr<RValue>> RetAtom::uses() const {
+	return {_value};
+}
+
+const std::shared_ptr<RValue>& RetAtom::value() const noexcept {
+	return _value;
+}
+
 ParamAtom::ParamAtom(std::shared_ptr<RValue> value) : _value(std::move(value)) {}
 
 std::string ParamAtom::toString() const {
@@ -341,6 +748,10 @@ void ParamAtom::generate(std::ostream& stream, Translator *translator, int scope
 	translator->codeGenFuncArgs.push_back(_value);
 }
 
+std::vector<std::shared_ptr<RValue>> ParamAtom::uses() const {
+	return {_value};
+}
 
-
-
+const std::shared_ptr<RValue>& ParamAtom::value() const noexcept {
+	return _value;
+}
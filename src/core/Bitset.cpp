@@ -0,0 +1,72 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/Bitset.h"
+
+Bitset::Bitset(size_t size, bool value) : _words((size + 63) / 64, value ? ~uint64_t(0) : 0), _size(size) {
+	// the bits past the end stay zero so that words can be compared as a whole
+	if (value && size % 64 != 0) _words.back() = (uint64_t(1) << (size % 64)) - 1;
+}
+
+size_t Bitset::size() const {
+	return _size;
+}
+
+bool Bitset::test(size_t index) const {
+	return (_words[index / 64] >> (index % 64)) & 1;
+}
+
+void Bitset::set(size_t index) {
+	_words[index / 64] |= uint64_t(1) << (index % 64);
+}
+
+void Bitset::reset(size_t index) {
+	_words[index / 64] &= ~(uint64_t(1) << (index % 64));
+}
+
+size_t Bitset::count() const {
+	size_t count = 0;
+	for (uint64_t word : _words) {
+		for (; word != 0; word &= word - 1) count++;
+	}
+	return count;
+}
+
+bool Bitset::unite(const Bitset& other) {
+	bool changed = false;
+	for (size_t i = 0; i < _words.size(); i++) {
+		uint64_t word = _words[i] | other._words[i];
+		changed = changed || word != _words[i];
+		_words[i] = word;
+	}
+	return changed;
+}
+
+bool Bitset::intersect(const Bitset& other) {
+	bool changed = false;
+	for (size_t i = 0; i < _words.size(); i++) {
+		uint64_t word = _words[i] & other._words[i];
+		changed = changed || word != _words[i];
+		_words[i] = word;
+	}
+	return changed;
+}
+
+bool Bitset::subtract(const Bitset& other) {
+	bool changed = false;
+	for (size_t i = 0; i < _words.size(); i++) {
+		uint64_t word = _words[i] & ~other._words[i];
+		changed = changed || word != _words[i];
+		_words[i] = word;
+	}
+	return changed;
+}
+
+bool Bitset::operator==(const Bitset& rhs) const {
+	return _size == rhs._size && _words == rhs._words;
+}
+
+bool Bitset::operator!=(const Bitset& rhs) const {
+	return !(rhs == *this);
+}
@@ -0,0 +1,109 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include "../include/BlockLayout.h"
+#include "../include/ControlFlowGraph.h"
+#include "../include/Translator.h"
+
+BlockLayout::BlockLayout(Translator& translator, const std::map<int, size_t>& hits)
+		: _translator(translator), _hits(hits) {}
+
+static bool fallsThrough(const std::shared_ptr<Atom>& atom) {
+	return !std::dynamic_pointer_cast<JumpAtom>(atom) && !std::dynamic_pointer_cast<SwitchAtom>(atom) &&
+	       !std::dynamic_pointer_cast<RetAtom>(atom) && !std::dynamic_pointer_cast<TailCallAtom>(atom);
+}
+
+bool BlockLayout::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	ControlFlowGraph graph(atoms);
+	size_t n = graph.size();
+	if (n < 2) return false;
+	// a block runs as often as its most executed atom, a block of labels only as often as the next one
+	std::vector<size_t> hits(n, 0);
+	int index = 0;
+	for (size_t block = 0; block < n; block++) {
+		for (size_t i = 0; i < graph[block].atoms.size(); i++, index++) {
+			auto it = _hits.find(index);
+			if (it != _hits.end()) hits[block] = std::max(hits[block], it->second);
+		}
+	}
+	for (size_t block = n - 1; block-- > 0;) {
+		const auto& blockAtoms = graph[block].atoms;
+		bool labels = std::all_of(blockAtoms.begin(), blockAtoms.end(), [](const std::shared_ptr<Atom>& atom) {
+			return std::dynamic_pointer_cast<LabelAtom>(atom) != nullptr;
+		});
+		if (labels && hits[block] == 0) hits[block] = hits[block + 1];
+	}
+	// chains start at the entry and at every hot block left over, a block falling off the end stays last
+	std::vector<bool> placed(n, false);
+	std::vector<size_t> order;
+	bool pinned = fallsThrough(graph[n - 1].atoms.back());
+	if (pinned) placed[n - 1] = true;
+	auto follow = [&](size_t block) {
+		while (true) {
+			placed[block] = true;
+			order.push_back(block);
+			int64_t next = -1;
+			for (size_t successor : graph[block].successors) {
+				if (placed[successor] || hits[successor] == 0) continue;
+				if (next == -1 || hits[successor] > hits[next] ||
+				    (hits[successor] == hits[next] && successor == block + 1)) {
+					next = successor;
+				}
+			}
+			if (next == -1) return;
+			block = next;
+		}
+	};
+	follow(0);
+	for (size_t block = 1; block < n; block++) {
+		if (!placed[block] && hits[block] > 0) follow(block);
+	}
+	for (size_t block = 1; block < n; block++) {
+		if (!placed[block]) order.push_back(block);
+	}
+	if (pinned) order.push_back(n - 1);
+	bool moved = false;
+	for (size_t k = 0; k < n; k++) moved |= order[k] != k;
+	if (!moved) return false;
+	// a block no longer followed by its fall-through successor jumps to it
+	auto labelOf = [&](size_t block) {
+		auto& blockAtoms = graph[block].atoms;
+		if (auto label = std::dynamic_pointer_cast<LabelAtom>(blockAtoms.front())) return label->label();
+		auto label = _translator.newLabel();
+		blockAtoms.insert(blockAtoms.begin(), std::make_shared<LabelAtom>(label));
+		return label;
+	};
+	std::vector<std::shared_ptr<LabelOperand>> fallLabels(n);
+	for (size_t k = 0; k < n; k++) {
+		size_t block = order[k];
+		bool followed = k + 1 < n && order[k + 1] == block + 1;
+		if (block + 1 < n && !followed && fallsThrough(graph[block].atoms.back())) fallLabels[block] = labelOf(block + 1);
+	}
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t k = 0; k < n; k++) {
+		size_t block = order[k];
+		int64_t next = k + 1 < n ? int64_t(order[k + 1]) : -1;
+		auto blockAtoms = graph[block].atoms;
+		auto last = blockAtoms.back();
+		if (auto jump = std::dynamic_pointer_cast<JumpAtom>(last)) {
+			if (graph.findLabel(jump->label()->labelId()) == next) blockAtoms.pop_back();
+		} else if (fallLabels[block]) {
+			auto conditional = std::dynamic_pointer_cast<ConditionalJumpAtom>(last);
+			if (conditional && graph.findLabel(conditional->label()->labelId()) == next) {
+				// the hot target follows, the jump goes to the old fall-through block instead
+				auto inverted = std::make_shared<ConditionalJumpAtom>(
+						ConditionalJumpAtom::invertCondition(conditional->condition()), conditional->left(),
+						conditional->right(), fallLabels[block]);
+				inverted->setLine(conditional->line());
+				blockAtoms.back() = inverted;
+			} else {
+				blockAtoms.push_back(std::make_shared<JumpAtom>(fallLabels[block]));
+			}
+		}
+		out.insert(out.end(), blockAtoms.begin(), blockAtoms.end());
+	}
+	atoms = out;
+	return true;
+}
@@ -0,0 +1,109 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <map>
+#include "../include/BranchFusion.h"
+
+static bool isMoveOf(const std::shared_ptr<Atom>& atom, int value, std::shared_ptr<MemoryOperand>& result) {
+	auto move = std::dynamic_pointer_cast<UnaryOpAtom>(atom);
+	if (!move || move->name() != "MOV") return false;
+	auto number = std::dynamic_pointer_cast<NumberOperand>(move->operand());
+	if (!number || number->value() != value) return false;
+	if (result && *result != *move->result()) return false;
+	result = move->result();
+	return true;
+}
+
+static bool isMemory(const std::shared_ptr<RValue>& operand, const MemoryOperand& memory) {
+	auto other = std::dynamic_pointer_cast<MemoryOperand>(operand);
+	return other && *other == memory;
+}
+
+static bool isNumber(const std::shared_ptr<RValue>& operand, int value) {
+	auto number = std::dynamic_pointer_cast<NumberOperand>(operand);
+	return number && number->value() == value;
+}
+
+static std::map<int, int> countReferences(const std::vector<std::shared_ptr<Atom>>& atoms) {
+	std::map<int, int> references;
+	for (const auto& atom : atoms) {
+		if (auto jump = std::dynamic_pointer_cast<JumpAtom>(atom)) {
+			references[jump->label()->labelId()]++;
+		} else if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom)) {
+			references[conditionalJump->label()->labelId()]++;
+		} else if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+			for (const auto& label : switchAtom->labels()) references[label->labelId()]++;
+		}
+	}
+	return references;
+}
+
+static bool isMaterialized(const std::vector<std::shared_ptr<Atom>>& atoms, size_t i,
+                           const std::map<int, int>& references, std::shared_ptr<MemoryOperand>& result) {
+	// (MOV 1, t) (CMP a, b, L) (MOV 0, t) (LBL L) with L reached from nowhere else
+	if (i + 3 >= atoms.size()) return false;
+	auto compare = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms[i + 1]);
+	auto label = std::dynamic_pointer_cast<LabelAtom>(atoms[i + 3]);
+	if (!isMoveOf(atoms[i], 1, result) || !compare || !isMoveOf(atoms[i + 2], 0, result) || !label) return false;
+	int labelId = label->label()->labelId();
+	return labelId == compare->label()->labelId() && references.at(labelId) == 1;
+}
+
+bool BranchFusion::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// E5_ materializes a relational result as (MOV 1, t) (CMP a, b, L) (MOV 0, t) (LBL L),
+	// and IfOp / WhileOp / ForOp then test it with (EQ, t, 0, exit). When t is read nowhere else
+	// the five atoms are the same as a single inverted jump on a and b.
+	std::map<size_t, int> uses;
+	for (const auto& atom : atoms) {
+		for (const auto& operand : atom->uses()) {
+			auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+			if (memory) uses[memory->index()]++;
+		}
+	}
+	auto references = countReferences(atoms);
+	bool changed = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t i = 0; i < atoms.size(); i++) {
+		if (i + 4 < atoms.size()) {
+			std::shared_ptr<MemoryOperand> result;
+			auto compare = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms[i + 1]);
+			auto branch = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms[i + 4]);
+			if (isMaterialized(atoms, i, references, result) &&
+			    branch && branch->condition() == "EQ" && isMemory(branch->left(), *result) &&
+			    isNumber(branch->right(), 0) && uses[result->index()] == 1) {
+				auto condition = ConditionalJumpAtom::invertCondition(compare->condition());
+				out.push_back(std::make_shared<ConditionalJumpAtom>(condition, compare->left(), compare->right(),
+				                                                    branch->label()));
+				changed = true;
+				i += 4;
+				continue;
+			}
+		}
+		out.push_back(atoms[i]);
+	}
+	if (changed) atoms = out;
+	return changed;
+}
+
+bool BranchFusion::materialize(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// a relational result that is kept as a value is computed with flag arithmetic instead,
+	// which is never longer than the two stores and the jumps around them
+	auto references = countReferences(atoms);
+	bool changed = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t i = 0; i < atoms.size(); i++) {
+		std::shared_ptr<MemoryOperand> result;
+		if (isMaterialized(atoms, i, references, result)) {
+			auto compare = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms[i + 1]);
+			out.push_back(std::make_shared<BinaryOpAtom>(compare->condition(), compare->left(), compare->right(),
+			                                             result));
+			changed = true;
+			i += 3;
+			continue;
+		}
+		out.push_back(atoms[i]);
+	}
+	if (changed) atoms = out;
+	return changed;
+}
@@ -0,0 +1,74 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/CallGraph.h"
+
+CallGraph::CallGraph(const std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms) {
+	for (const auto& pair : atoms) {
+		auto& callees = _callees[pair.first];
+		for (const auto& atom : pair.second) {
+			if (auto call = std::dynamic_pointer_cast<CallAtom>(atom)) {
+				callees.insert(call->function()->index());
+			} else if (auto tailCall = std::dynamic_pointer_cast<TailCallAtom>(atom)) {
+				callees.insert(tailCall->function()->index());
+			}
+		}
+	}
+}
+
+const std::set<Scope>& CallGraph::callees(Scope function) const {
+	auto it = _callees.find(function);
+	return it == _callees.end() ? _empty : it->second;
+}
+
+bool CallGraph::reaches(Scope from, Scope to) const {
+	std::set<Scope> visited;
+	std::vector<Scope> stack = {from};
+	while (!stack.empty()) {
+		Scope function = stack.back();
+		stack.pop_back();
+		for (Scope callee : callees(function)) {
+			if (callee == to) return true;
+			if (visited.insert(callee).second) stack.push_back(callee);
+		}
+	}
+	return false;
+}
+
+std::set<Scope> CallGraph::reachable(Scope root) const {
+	std::set<Scope> visited = {root};
+	std::vector<Scope> stack = {root};
+	while (!stack.empty()) {
+		Scope function = stack.back();
+		stack.pop_back();
+		for (Scope callee : callees(function)) {
+			if (visited.insert(callee).second) stack.push_back(callee);
+		}
+	}
+	return visited;
+}
+
+std::vector<Scope> CallGraph::postorder() const {
+	// callees before their callers, cycles are cut at the first revisited function
+	std::vector<Scope> order;
+	std::set<Scope> visited;
+	for (const auto& pair : _callees) {
+		if (!visited.insert(pair.first).second) continue;
+		std::vector<std::pair<Scope, std::set<Scope>::const_iterator>> stack = {{pair.first, pair.second.begin()}};
+		while (!stack.empty()) {
+			Scope function = stack.back().first;
+			auto& next = stack.back().second;
+			if (next != callees(function).end()) {
+				Scope callee = *next++;
+				if (_callees.count(callee) && visited.insert(callee).second) {
+					stack.emplace_back(callee, callees(callee).begin());
+				}
+			} else {
+				order.push_back(function);
+				stack.pop_back();
+			}
+		}
+	}
+	return order;
+}
@@ -0,0 +1,339 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <deque>
+#include "../include/ConstantPropagation.h"
+#include "../include/Translator.h"
+
+typedef ConstantPropagation::LatticeValue LatticeValue;
+
+static LatticeValue constant(int value) {
+	LatticeValue out;
+	out._kind = LatticeValue::Kind::constant;
+	out._value = ConstantPropagation::normalize(value);
+	return out;
+}
+
+static LatticeValue overdefined() {
+	LatticeValue out;
+	out._kind = LatticeValue::Kind::overdefined;
+	return out;
+}
+
+static bool fold(const std::string& name, int left, int right, int& out) {
+	if (name == "ADD") out = left + right;
+	else if (name == "SUB") out = left - right;
+	else if (name == "MUL") out = left * right;
+	else if (name == "AND") out = left & right;
+	else if (name == "OR") out = left | right;
+	else if (name == "EQ" || name == "NE" || name == "LT" || name == "GT" || name == "LE" || name == "GE") {
+		out = ConstantPropagation::compare(name, left, right) ? 1 : 0;
+	} else return false;
+	return true;
+}
+
+static bool isGlobalVar(const SymbolTable::TableRecord& record) {
+	return record._scope == GLOBAL_SCOPE && record._kind == SymbolTable::TableRecord::RecordKind::var;
+}
+
+bool ConstantPropagation::LatticeValue::operator==(const LatticeValue& rhs) const {
+	return _kind == rhs._kind && (_kind != Kind::constant || _value == rhs._value);
+}
+
+bool ConstantPropagation::LatticeValue::operator!=(const LatticeValue& rhs) const {
+	return !(rhs == *this);
+}
+
+ConstantPropagation::ConstantPropagation(const SymbolTable& symbolTable,
+                                         const std::map<Scope, std::vector<std::shared_ptr<Atom>>>& program,
+                                         const SideEffects& sideEffects)
+		: _symbolTable(symbolTable), _sideEffects(sideEffects) {
+	std::vector<bool> written(symbolTable.size(), false);
+	for (const auto& pair : program) {
+		for (const auto& atom : pair.second) {
+			auto def = atom->def();
+			if (def) written[def->index()] = true;
+		}
+	}
+	_entryState = State(symbolTable.size(), overdefined());
+	for (size_t i = 0; i < symbolTable.size(); i++) {
+		const auto& record = symbolTable._records[i];
+		if (isGlobalVar(record) && !written[i]) {
+			_entryState[i] = constant(record._init);
+		}
+	}
+}
+
+int ConstantPropagation::normalize(int value) {
+	value &= 0xFF;
+	return value >= 0x80 ? value - 0x100 : value;
+}
+
+bool ConstantPropagation::compare(const std::string& condition, int left, int right) {
+	// mirrors the flags checked by ConditionalJumpAtom::generate after CMP B
+	int difference = (left - right) & 0xFF;
+	bool sign = (difference & 0x80) != 0;
+	bool zero = difference == 0;
+	if (condition == "EQ") return zero;
+	if (condition == "NE") return !zero;
+	if (condition == "GT") return !sign && !zero;
+	if (condition == "LT") return sign;
+	if (condition == "GE") return !sign;
+	if (condition == "LE") return sign || zero;
+	throw CodeGenerationException("Unexpected condition " + condition);
+}
+
+LatticeValue ConstantPropagation::evaluate(const std::shared_ptr<RValue>& operand, const State& state) const {
+	if (auto number = std::dynamic_pointer_cast<NumberOperand>(operand)) {
+		return constant(number->value());
+	}
+	auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+	return state[memory->index()];
+}
+
+void ConstantPropagation::transfer(const std::shared_ptr<Atom>& atom, State& state) const {
+	if (std::dynamic_pointer_cast<CallAtom>(atom) && _sideEffects.of(atom).writesGlobals) {
+		for (size_t i = 0; i < state.size(); i++) {
+			if (isGlobalVar(_symbolTable._records[i]) && _entryState[i]._kind != LatticeValue::Kind::constant) {
+				state[i] = overdefined();
+			}
+		}
+	}
+	auto def = atom->def();
+	if (!def) return;
+	LatticeValue value = overdefined();
+	if (auto binary = std::dynamic_pointer_cast<BinaryOpAtom>(atom)) {
+		auto left = evaluate(binary->left(), state);
+		auto right = evaluate(binary->right(), state);
+		int folded;
+		bool absorbing = binary->name() == "MUL" || binary->name() == "AND";
+		if (left._kind == LatticeValue::Kind::constant && right._kind == LatticeValue::Kind::constant &&
+		    fold(binary->name(), left._value, right._value, folded)) {
+			value = constant(folded);
+		} else if (absorbing && ((left._kind == LatticeValue::Kind::constant && left._value == 0) ||
+		                         (right._kind == LatticeValue::Kind::constant && right._value == 0))) {
+			value = constant(0);
+		} else if (left._kind == LatticeValue::Kind::undefined || right._kind == LatticeValue::Kind::undefined) {
+			value = LatticeValue();
+		}
+	} else if (auto unary = std::dynamic_pointer_cast<UnaryOpAtom>(atom)) {
+		auto operand = evaluate(unary->operand(), state);
+		if (operand._kind != LatticeValue::Kind::constant) {
+			value = operand;
+		} else if (unary->name() == "MOV") {
+			value = operand;
+		} else if (unary->name() == "NEG") {
+			value = constant(-operand._value);
+		} else if (unary->name() == "NOT") {
+			value = constant(~operand._value);
+		}
+	}
+	state[def->index()] = value;
+}
+
+int ConstantPropagation::branchOutcome(const std::shared_ptr<ConditionalJumpAtom>& atom, const State& state) const {
+	auto left = evaluate(atom->left(), state);
+	auto right = evaluate(atom->right(), state);
+	if (left._kind == LatticeValue::Kind::overdefined || right._kind == LatticeValue::Kind::overdefined) {
+		return -1;
+	}
+	if (left._kind == LatticeValue::Kind::undefined || right._kind == LatticeValue::Kind::undefined) {
+		return -2;
+	}
+	return compare(atom->condition(), left._value, right._value) ? 1 : 0;
+}
+
+std::shared_ptr<RValue> ConstantPropagation::substitute(const std::shared_ptr<RValue>& operand, const State& state,
+                                                        const std::map<size_t, std::shared_ptr<MemoryOperand>>& copies) const {
+	auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+	if (!memory) return operand;
+	const auto& value = state[memory->index()];
+	if (value._kind == LatticeValue::Kind::constant) {
+		return std::make_shared<NumberOperand>(value._value);
+	}
+	auto copy = copies.find(memory->index());
+	if (copy != copies.end()) {
+		return copy->second;
+	}
+	return operand;
+}
+
+std::shared_ptr<Atom> ConstantPropagation::rewrite(const std::shared_ptr<Atom>& atom, const State& state,
+                                                   const std::map<size_t, std::shared_ptr<MemoryOperand>>& copies) const {
+	if (auto binary = std::dynamic_pointer_cast<BinaryOpAtom>(atom)) {
+		auto left = substitute(binary->left(), state, copies);
+		auto right = substitute(binary->right(), state, copies);
+		if (left != binary->left() || right != binary->right()) {
+			return std::make_shared<BinaryOpAtom>(binary->name(), left, right, binary->result());
+		}
+	} else if (auto unary = std::dynamic_pointer_cast<UnaryOpAtom>(atom)) {
+		auto operand = substitute(unary->operand(), state, copies);
+		if (operand != unary->operand()) {
+			return std::make_shared<UnaryOpAtom>(unary->name(), operand, unary->result());
+		}
+	} else if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom)) {
+		auto left = substitute(conditionalJump->left(), state, copies);
+		auto right = substitute(conditionalJump->right(), state, copies);
+		if (left != conditionalJump->left() || right != conditionalJump->right()) {
+			return std::make_shared<ConditionalJumpAtom>(conditionalJump->condition(), left, right,
+			                                             conditionalJump->label());
+		}
+	} else if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+		auto value = substitute(switchAtom->value(), state, copies);
+		if (value != switchAtom->value()) {
+			return std::make_shared<SwitchAtom>(value, switchAtom->cases(), switchAtom->defaultLabel());
+		}
+	} else if (auto out = std::dynamic_pointer_cast<OutAtom>(atom)) {
+		auto value = std::dynamic_pointer_cast<RValue>(out->value());
+		if (value) {
+			auto substituted = substitute(value, state, copies);
+			if (substituted != value) return std::make_shared<OutAtom>(substituted);
+		}
+	} else if (auto ret = std::dynamic_pointer_cast<RetAtom>(atom)) {
+		auto value = substitute(ret->value(), state, copies);
+		if (value != ret->value()) return std::make_shared<RetAtom>(value);
+	} else if (auto param = std::dynamic_pointer_cast<ParamAtom>(atom)) {
+		auto value = substitute(param->value(), state, copies);
+		if (value != param->value()) return std::make_shared<ParamAtom>(value);
+	}
+	return atom;
+}
+
+bool ConstantPropagation::meet(State& target, const State& source) {
+	bool changed = false;
+	for (size_t i = 0; i < target.size(); i++) {
+		LatticeValue value = target[i];
+		if (source[i]._kind == LatticeValue::Kind::undefined) continue;
+		if (value._kind == LatticeValue::Kind::undefined) value = source[i];
+		else if (value != source[i]) value = overdefined();
+		if (value != target[i]) {
+			target[i] = value;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+bool ConstantPropagation::run(std::vector<std::shared_ptr<Atom>>& atoms, const std::map<size_t, int>& parameters) const {
+	ControlFlowGraph cfg(atoms);
+	if (cfg.size() == 0) return false;
+	std::vector<State> in(cfg.size(), State(_symbolTable.size()));
+	std::vector<bool> executable(cfg.size(), false);
+	std::vector<bool> queued(cfg.size(), false);
+	std::deque<size_t> worklist = {0};
+	in[0] = _entryState;
+	// temps allocated by later passes are locals
+	in[0].resize(_symbolTable.size(), overdefined());
+	// parameters that every call site passes as the same constant
+	for (const auto& parameter : parameters) {
+		in[0][parameter.first] = constant(parameter.second);
+	}
+	executable[0] = true;
+	queued[0] = true;
+	while (!worklist.empty()) {
+		size_t block = worklist.front();
+		worklist.pop_front();
+		queued[block] = false;
+		State state = in[block];
+		for (const auto& atom : cfg[block].atoms) {
+			transfer(atom, state);
+		}
+		std::vector<size_t> edges = cfg[block].successors;
+		auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(cfg[block].atoms.back());
+		if (conditionalJump) {
+			int outcome = branchOutcome(conditionalJump, state);
+			size_t target = cfg.findLabel(conditionalJump->label()->labelId());
+			edges.clear();
+			if (outcome == 1 || outcome == -1) edges.push_back(target);
+			if ((outcome == 0 || outcome == -1) && block + 1 < cfg.size()) edges.push_back(block + 1);
+		}
+		auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(cfg[block].atoms.back());
+		if (switchAtom) {
+			auto value = evaluate(switchAtom->value(), state);
+			if (value._kind == LatticeValue::Kind::undefined) {
+				edges.clear();
+			} else if (value._kind == LatticeValue::Kind::constant) {
+				edges = {size_t(cfg.findLabel(switchAtom->target(value._value)->labelId()))};
+			}
+		}
+		for (size_t successor : edges) {
+			bool changed = meet(in[successor], state);
+			if (!executable[successor]) {
+				executable[successor] = true;
+				changed = true;
+			}
+			if (changed && !queued[successor]) {
+				queued[successor] = true;
+				worklist.push_back(successor);
+			}
+		}
+	}
+
+	bool changed = false;
+	for (size_t block = 0; block < cfg.size(); block++) {
+		auto& blockAtoms = cfg[block].atoms;
+		if (!executable[block]) {
+			changed = true;
+			blockAtoms.clear();
+			continue;
+		}
+		State state = in[block];
+		std::map<size_t, std::shared_ptr<MemoryOperand>> copies;
+		std::vector<std::shared_ptr<Atom>> rewritten;
+		for (const auto& atom : blockAtoms) {
+			if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom)) {
+				int outcome = branchOutcome(conditionalJump, state);
+				if (outcome == 1) {
+					rewritten.push_back(std::make_shared<JumpAtom>(conditionalJump->label()));
+					changed = true;
+					continue;
+				} else if (outcome == 0) {
+					changed = true;
+					continue;
+				}
+			}
+			if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+				auto value = evaluate(switchAtom->value(), state);
+				if (value._kind == LatticeValue::Kind::constant) {
+					rewritten.push_back(std::make_shared<JumpAtom>(switchAtom->target(value._value)));
+					changed = true;
+					continue;
+				}
+			}
+			auto newAtom = rewrite(atom, state, copies);
+			transfer(atom, state);
+			auto def = atom->def();
+			if (def && (std::dynamic_pointer_cast<BinaryOpAtom>(atom) || std::dynamic_pointer_cast<UnaryOpAtom>(atom))) {
+				const auto& value = state[def->index()];
+				auto unary = std::dynamic_pointer_cast<UnaryOpAtom>(newAtom);
+				bool alreadyFolded = unary && unary->name() == "MOV" &&
+				                     std::dynamic_pointer_cast<NumberOperand>(unary->operand());
+				if (value._kind == LatticeValue::Kind::constant && !alreadyFolded) {
+					newAtom = std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(value._value), def);
+				}
+			}
+			if (def || std::dynamic_pointer_cast<CallAtom>(atom)) {
+				bool call = std::dynamic_pointer_cast<CallAtom>(atom) && _sideEffects.of(atom).writesGlobals;
+				for (auto it = copies.begin(); it != copies.end();) {
+					bool clobbered = (def && (it->first == def->index() || it->second->index() == def->index())) ||
+					                 (call && (isGlobalVar(_symbolTable._records[it->first]) ||
+					                           isGlobalVar(_symbolTable._records[it->second->index()])));
+					it = clobbered ? copies.erase(it) : std::next(it);
+				}
+			}
+			auto move = std::dynamic_pointer_cast<UnaryOpAtom>(newAtom);
+			if (move && move->name() == "MOV") {
+				auto source = std::dynamic_pointer_cast<MemoryOperand>(move->operand());
+				if (source && *source != *move->result()) {
+					copies[move->result()->index()] = source;
+				}
+			}
+			if (newAtom != atom) changed = true;
+			rewritten.push_back(newAtom);
+		}
+		blockAtoms = rewritten;
+	}
+	if (changed) atoms = cfg.atoms();
+	return changed;
+}
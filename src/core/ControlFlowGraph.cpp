@@ -0,0 +1,205 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include "../include/ControlFlowGraph.h"
+#include "../include/Translator.h"
+
+static bool isTerminator(const std::shared_ptr<Atom>& atom) {
+	return std::dynamic_pointer_cast<JumpAtom>(atom) ||
+	       std::dynamic_pointer_cast<ConditionalJumpAtom>(atom) ||
+	       std::dynamic_pointer_cast<SwitchAtom>(atom) ||
+	       std::dynamic_pointer_cast<RetAtom>(atom) ||
+	       std::dynamic_pointer_cast<TailCallAtom>(atom);
+}
+
+ControlFlowGraph::ControlFlowGraph(const std::vector<std::shared_ptr<Atom>>& atoms) {
+	for (const auto& atom : atoms) {
+		auto labelAtom = std::dynamic_pointer_cast<LabelAtom>(atom);
+		if (_blocks.empty() || (labelAtom && !_blocks.back().atoms.empty()) ||
+		    (!_blocks.back().atoms.empty() && isTerminator(_blocks.back().atoms.back()))) {
+			_blocks.emplace_back();
+		}
+		if (labelAtom) {
+			_labels[labelAtom->label()->labelId()] = _blocks.size() - 1;
+		}
+		_blocks.back().atoms.push_back(atom);
+	}
+	for (size_t i = 0; i < _blocks.size(); i++) {
+		const auto& last = _blocks[i].atoms.back();
+		bool fallsThrough = true;
+		std::vector<std::shared_ptr<LabelOperand>> targets;
+		if (auto jump = std::dynamic_pointer_cast<JumpAtom>(last)) {
+			targets.push_back(jump->label());
+			fallsThrough = false;
+		} else if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(last)) {
+			targets.push_back(conditionalJump->label());
+		} else if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(last)) {
+			targets = switchAtom->labels();
+			fallsThrough = false;
+		} else if (std::dynamic_pointer_cast<RetAtom>(last) || std::dynamic_pointer_cast<TailCallAtom>(last)) {
+			fallsThrough = false;
+		}
+		for (const auto& target : targets) {
+			int64_t block = findLabel(target->labelId());
+			if (block == -1) {
+				throw CodeGenerationException("Jump to an undefined label " + target->toString());
+			}
+			link(i, block);
+		}
+		if (fallsThrough && i + 1 < _blocks.size()) {
+			link(i, i + 1);
+		}
+	}
+}
+
+void ControlFlowGraph::link(size_t from, size_t to) {
+	auto& successors = _blocks[from].successors;
+	if (std::find(successors.begin(), successors.end(), to) == successors.end()) {
+		successors.push_back(to);
+		_blocks[to].predecessors.push_back(from);
+	}
+}
+
+size_t ControlFlowGraph::size() const {
+	return _blocks.size();
+}
+
+BasicBlock& ControlFlowGraph::operator[](size_t index) {
+	return _blocks[index];
+}
+
+const BasicBlock& ControlFlowGraph::operator[](size_t index) const {
+	return _blocks[index];
+}
+
+int64_t ControlFlowGraph::findLabel(int labelId) const {
+	auto it = _labels.find(labelId);
+	return it == _labels.end() ? -1 : int64_t(it->second);
+}
+
+std::vector<size_t> ControlFlowGraph::reversePostorder() const {
+	std::vector<size_t> order;
+	if (_blocks.empty()) return order;
+	std::vector<bool> visited(_blocks.size(), false);
+	std::vector<std::pair<size_t, size_t>> stack = {{0, 0}};
+	visited[0] = true;
+	while (!stack.empty()) {
+		auto& top = stack.back();
+		const auto& successors = _blocks[top.first].successors;
+		if (top.second < successors.size()) {
+			size_t next = successors[top.second++];
+			if (!visited[next]) {
+				visited[next] = true;
+				stack.emplace_back(next, 0);
+			}
+		} else {
+			order.push_back(top.first);
+			stack.pop_back();
+		}
+	}
+	std::reverse(order.begin(), order.end());
+	return order;
+}
+
+std::vector<std::vector<bool>> ControlFlowGraph::dominators() const {
+	// dominators[b][a] is set when a dominates b
+	size_t n = _blocks.size();
+	std::vector<std::vector<bool>> dominators(n, std::vector<bool>(n, true));
+	if (n == 0) return dominators;
+	dominators[0].assign(n, false);
+	dominators[0][0] = true;
+	auto order = reversePostorder();
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (size_t block : order) {
+			if (block == 0) continue;
+			std::vector<bool> next(n, true);
+			for (size_t predecessor : _blocks[block].predecessors) {
+				for (size_t i = 0; i < n; i++) {
+					next[i] = next[i] && dominators[predecessor][i];
+				}
+			}
+			next[block] = true;
+			if (next != dominators[block]) {
+				dominators[block] = next;
+				changed = true;
+			}
+		}
+	}
+	return dominators;
+}
+
+std::vector<Loop> ControlFlowGraph::loops() const {
+	// natural loops of the back edges, merged by header, innermost first
+	auto dominators = this->dominators();
+	auto order = reversePostorder();
+	std::vector<bool> reachable(_blocks.size(), false);
+	for (size_t block : order) reachable[block] = true;
+	std::map<size_t, Loop> loops;
+	for (size_t latch : order) {
+		for (size_t header : _blocks[latch].successors) {
+			if (!dominators[latch][header]) continue;
+			auto& loop = loops[header];
+			loop.header = header;
+			loop.latches.push_back(latch);
+			std::vector<bool> inLoop(_blocks.size(), false);
+			for (size_t block : loop.blocks) inLoop[block] = true;
+			inLoop[header] = true;
+			std::vector<size_t> stack;
+			if (!inLoop[latch]) {
+				inLoop[latch] = true;
+				stack.push_back(latch);
+			}
+			while (!stack.empty()) {
+				size_t block = stack.back();
+				stack.pop_back();
+				for (size_t predecessor : _blocks[block].predecessors) {
+					if (reachable[predecessor] && !inLoop[predecessor]) {
+						inLoop[predecessor] = true;
+						stack.push_back(predecessor);
+					}
+				}
+			}
+			loop.blocks.clear();
+			for (size_t block = 0; block < _blocks.size(); block++) {
+				if (inLoop[block]) loop.blocks.push_back(block);
+			}
+		}
+	}
+	std::vector<Loop> out;
+	for (const auto& pair : loops) out.push_back(pair.second);
+	std::stable_sort(out.begin(), out.end(), [](const Loop& a, const Loop& b) {
+		return a.blocks.size() < b.blocks.size();
+	});
+	return out;
+}
+
+bool ControlFlowGraph::hasPreheaderSlot(const Loop& loop) const {
+	// atoms can be placed right before the header label only if from outside the loop
+	// the header is entered just by falling through from the block laid out before it
+	std::vector<bool> inLoop(_blocks.size(), false);
+	for (size_t block : loop.blocks) inLoop[block] = true;
+	if (loop.header == 0 || inLoop[loop.header - 1]) return false;
+	auto label = std::dynamic_pointer_cast<LabelAtom>(_blocks[loop.header].atoms.front());
+	if (!label) return false;
+	const auto& predecessors = _blocks[loop.header].predecessors;
+	for (size_t predecessor : predecessors) {
+		if (!inLoop[predecessor] && predecessor != loop.header - 1) return false;
+	}
+	if (std::find(predecessors.begin(), predecessors.end(), loop.header - 1) == predecessors.end()) return false;
+	const auto& last = _blocks[loop.header - 1].atoms.back();
+	if (std::dynamic_pointer_cast<JumpAtom>(last) || std::dynamic_pointer_cast<SwitchAtom>(last)) return false;
+	auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(last);
+	return !conditionalJump || conditionalJump->label()->labelId() != label->label()->labelId();
+}
+
+std::vector<std::shared_ptr<Atom>> ControlFlowGraph::atoms() const {
+	std::vector<std::shared_ptr<Atom>> out;
+	for (const auto& block : _blocks) {
+		out.insert(out.end(), block.atoms.begin(), block.atoms.end());
+	}
+	return out;
+}
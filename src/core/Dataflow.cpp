@@ -0,0 +1,60 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <set>
+#include "../include/Dataflow.h"
+
+Dataflow::Dataflow(const ControlFlowGraph& graph, const Problem& problem) {
+	size_t n = graph.size();
+	bool forward = problem.direction == Direction::forward;
+	bool unite = problem.meet == Meet::unite;
+	_in.assign(n, Bitset(problem.width, !unite));
+	_out.assign(n, Bitset(problem.width, !unite));
+	// blocks are visited in reverse postorder, or in postorder for backward problems, so that
+	// most of them see their final inputs on the first pass. Unreachable blocks go last.
+	auto order = graph.reversePostorder();
+	std::vector<bool> reachable(n, false);
+	for (size_t block : order) reachable[block] = true;
+	for (size_t block = 0; block < n; block++) {
+		if (!reachable[block]) order.push_back(block);
+	}
+	if (!forward) std::reverse(order.begin(), order.end());
+	std::vector<size_t> position(n);
+	for (size_t i = 0; i < n; i++) position[order[i]] = i;
+
+	std::set<size_t> worklist;
+	for (size_t i = 0; i < n; i++) worklist.insert(i);
+	while (!worklist.empty()) {
+		size_t block = order[*worklist.begin()];
+		worklist.erase(worklist.begin());
+		const auto& sources = forward ? graph[block].predecessors : graph[block].successors;
+		const auto& targets = forward ? graph[block].successors : graph[block].predecessors;
+		auto& input = forward ? _in[block] : _out[block];
+		auto& output = forward ? _out[block] : _in[block];
+		auto& results = forward ? _out : _in;
+		// the entry block may also be a loop header, so the boundary is met with its predecessors
+		bool boundary = forward ? block == 0 : sources.empty();
+		input = boundary ? problem.boundary : Bitset(problem.width, !unite);
+		for (size_t source : sources) {
+			if (unite) input.unite(results[source]);
+			else input.intersect(results[source]);
+		}
+		Bitset next = input;
+		next.subtract(problem.kill[block]);
+		next.unite(problem.gen[block]);
+		if (next != output) {
+			output = next;
+			for (size_t target : targets) worklist.insert(position[target]);
+		}
+	}
+}
+
+const Bitset& Dataflow::in(size_t block) const {
+	return _in[block];
+}
+
+const Bitset& Dataflow::out(size_t block) const {
+	return _out[block];
+}
@@ -0,0 +1,539 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <cctype>
+#include <set>
+#include <sstream>
+#include <utility>
+#include "../include/Assembly.h"
+#include "../include/Emulator.h"
+
+static const std::map<std::string, int> registers = {
+		{"B", 0}, {"C", 1}, {"D", 2}, {"E", 3}, {"H", 4}, {"L", 5}, {"M", 6}, {"A", 7}
+};
+
+static const std::map<std::string, int> pairs = {
+		{"B", 0}, {"D", 1}, {"H", 2}, {"SP", 3}, {"PSW", 3}
+};
+
+static const std::map<std::string, int> conditions = {
+		{"NZ", 0}, {"Z", 1}, {"NC", 2}, {"C", 3}, {"PO", 4}, {"PE", 5}, {"P", 6}, {"M", 7}
+};
+
+static const std::set<std::string> helpers = {"@MULT", "@DIV", "@PRINT"};
+
+// the text of the line before its comment, quotes are kept
+static std::string stripComment(const std::string& line) {
+	size_t end = 0;
+	for (bool quoted = false; end < line.size() && (quoted || line[end] != ';'); end++) {
+		if (line[end] == '\'') quoted = !quoted;
+	}
+	return line.substr(0, end);
+}
+
+static std::string labelOf(const std::string& text) {
+	auto colon = text.find(':');
+	if (colon == std::string::npos || text.find_first_of(" \t'") < colon) return "";
+	return text.substr(0, colon);
+}
+
+uint16_t Emulator::value(const std::string& operand, size_t line) const {
+	if (operand.size() >= 3 && operand.front() == '\'') return static_cast<uint8_t>(operand[1]);
+	if (!operand.empty() && (isdigit(operand.front()) || operand.front() == '-')) {
+		bool hex = toupper(operand.back()) == 'H';
+		long number = std::stol(hex ? operand.substr(0, operand.size() - 1) : operand, nullptr, hex ? 16 : 10);
+		return static_cast<uint16_t>(number);
+	}
+	auto it = _labels.find(operand);
+	if (it == _labels.end()) {
+		throw EmulationException("Unknown label \"" + operand + "\" on line " + std::to_string(line + 1));
+	}
+	return it->second;
+}
+
+Emulator::Instruction Emulator::decode(const std::string& mnemonic, const std::vector<std::string>& operands,
+                                       size_t line) const {
+	static const std::map<std::string, Opcode> opcodes = {
+			{"MOV", Opcode::MOV}, {"MVI", Opcode::MVI}, {"LXI", Opcode::LXI}, {"LDA", Opcode::LDA},
+			{"STA", Opcode::STA}, {"LHLD", Opcode::LHLD}, {"SHLD", Opcode::SHLD}, {"LDAX", Opcode::LDAX},
+			{"STAX", Opcode::STAX}, {"XCHG", Opcode::XCHG}, {"XTHL", Opcode::XTHL}, {"SPHL", Opcode::SPHL},
+			{"PCHL", Opcode::PCHL}, {"ADD", Opcode::ADD}, {"ADC", Opcode::ADC}, {"SUB", Opcode::SUB},
+			{"SBB", Opcode::SBB}, {"ANA", Opcode::ANA}, {"XRA", Opcode::XRA}, {"ORA", Opcode::ORA},
+			{"CMP", Opcode::CMP}, {"ADI", Opcode::ADI}, {"ACI", Opcode::ACI}, {"SUI", Opcode::SUI},
+			{"SBI", Opcode::SBI}, {"ANI", Opcode::ANI}, {"XRI", Opcode::XRI}, {"ORI", Opcode::ORI},
+			{"CPI", Opcode::CPI}, {"INR", Opcode::INR}, {"DCR", Opcode::DCR}, {"INX", Opcode::INX},
+			{"DCX", Opcode::DCX}, {"DAD", Opcode::DAD}, {"RLC", Opcode::RLC}, {"RRC", Opcode::RRC},
+			{"RAL", Opcode::RAL}, {"RAR", Opcode::RAR}, {"CMA", Opcode::CMA}, {"CMC", Opcode::CMC},
+			{"STC", Opcode::STC}, {"JMP", Opcode::JMP}, {"CALL", Opcode::CALL}, {"RET", Opcode::RET},
+			{"RST", Opcode::RST}, {"PUSH", Opcode::PUSH}, {"POP", Opcode::POP}, {"IN", Opcode::IN},
+			{"OUT", Opcode::OUT}, {"EI", Opcode::EI}, {"DI", Opcode::DI}, {"HLT", Opcode::HLT},
+			{"NOP", Opcode::NOP}
+	};
+	Instruction instruction;
+	instruction.line = line;
+	auto opcode = opcodes.find(mnemonic);
+	if (opcode != opcodes.end()) {
+		instruction.opcode = opcode->second;
+	} else if (!mnemonic.empty() && conditions.count(mnemonic.substr(1))) {
+		static const std::map<char, Opcode> conditional = {{'J', Opcode::JCC}, {'C', Opcode::CCC}, {'R', Opcode::RCC}};
+		auto it = conditional.find(mnemonic[0]);
+		if (it == conditional.end()) throw EmulationException("Unknown instruction " + mnemonic);
+		instruction.opcode = it->second;
+		instruction.first = conditions.at(mnemonic.substr(1));
+	} else {
+		throw EmulationException("Unknown instruction \"" + mnemonic + "\" on line " + std::to_string(line + 1));
+	}
+	auto operand = [&](size_t i) -> const std::string& {
+		if (i >= operands.size()) {
+			throw EmulationException("Missing operand of " + mnemonic + " on line " + std::to_string(line + 1));
+		}
+		return operands[i];
+	};
+	auto reg = [&](size_t i) {
+		auto it = registers.find(operand(i));
+		if (it == registers.end()) throw EmulationException("Bad register on line " + std::to_string(line + 1));
+		return it->second;
+	};
+	auto regPair = [&](size_t i) {
+		auto it = pairs.find(operand(i));
+		if (it == pairs.end()) throw EmulationException("Bad register pair on line " + std::to_string(line + 1));
+		return it->second;
+	};
+	switch (instruction.opcode) {
+		case Opcode::MOV:
+			instruction.first = reg(0);
+			instruction.second = reg(1);
+			break;
+		case Opcode::MVI:
+			instruction.first = reg(0);
+			instruction.value = value(operand(1), line);
+			break;
+		case Opcode::LXI:
+			instruction.first = regPair(0);
+			instruction.value = value(operand(1), line);
+			break;
+		case Opcode::ADD: case Opcode::ADC: case Opcode::SUB: case Opcode::SBB: case Opcode::ANA:
+		case Opcode::XRA: case Opcode::ORA: case Opcode::CMP: case Opcode::INR: case Opcode::DCR:
+			instruction.first = reg(0);
+			break;
+		case Opcode::INX: case Opcode::DCX: case Opcode::DAD: case Opcode::PUSH: case Opcode::POP:
+		case Opcode::LDAX: case Opcode::STAX:
+			instruction.first = regPair(0);
+			break;
+		case Opcode::CALL: case Opcode::JMP:
+			// a JMP to a helper is the tail of a RST vector, the helper returns to the RST
+			if (helpers.count(operand(0))) {
+				instruction.first = instruction.opcode == Opcode::JMP;
+				instruction.opcode = Opcode::HELPER;
+				instruction.helper = operand(0);
+				break;
+			}
+			instruction.value = value(operand(0), line);
+			break;
+		case Opcode::JCC: case Opcode::CCC:
+			instruction.value = value(operand(0), line);
+			break;
+		case Opcode::RCC: case Opcode::RET: case Opcode::XCHG: case Opcode::XTHL: case Opcode::SPHL:
+		case Opcode::PCHL: case Opcode::RLC: case Opcode::RRC: case Opcode::RAL: case Opcode::RAR:
+		case Opcode::CMA: case Opcode::CMC: case Opcode::STC: case Opcode::EI: case Opcode::DI:
+		case Opcode::HLT: case Opcode::NOP: case Opcode::HELPER:
+			break;
+		default:
+			instruction.value = value(operand(0), line);
+			break;
+	}
+	return instruction;
+}
+
+Emulator::Emulator(const std::string& code) : _memory(0x10000, 0), _instructionAt(0x10000, -1) {
+	std::vector<std::string> lines;
+	std::istringstream iss(code);
+	for (std::string line; std::getline(iss, line);) lines.push_back(line);
+	// the first pass places the labels, the second one decodes the instructions and stores the data
+	for (int pass = 0; pass < 2; pass++) {
+		size_t address = 0;
+		for (size_t i = 0; i < lines.size(); i++) {
+			std::string text = stripComment(lines[i]);
+			auto label = labelOf(text);
+			if (!label.empty()) {
+				if (pass == 0) _labels[label] = static_cast<uint16_t>(address);
+				text = text.substr(label.size() + 1);
+			}
+			std::istringstream words(text);
+			std::string mnemonic;
+			if (!(words >> mnemonic)) continue;
+			if (mnemonic == "ORG") {
+				std::string origin;
+				words >> origin;
+				address = value(origin, i);
+				continue;
+			}
+			if (mnemonic == "END") {
+				_end = static_cast<long>(address);
+				continue;
+			}
+			size_t size = Assembly::instructionSize(lines[i]);
+			if (pass == 1 && (mnemonic == "DB" || mnemonic == "DW")) {
+				// the items of a DB, a quoted item is one byte per character
+				std::string rest;
+				std::getline(words, rest);
+				size_t at = address;
+				std::string item;
+				bool quoted = false;
+				auto flush = [&]() {
+					while (!item.empty() && isspace(item.back())) item.pop_back();
+					if (item.empty()) return;
+					uint16_t word = value(item, i);
+					_memory[at++ & 0xFFFF] = static_cast<uint8_t>(word);
+					if (mnemonic == "DW") _memory[at++ & 0xFFFF] = static_cast<uint8_t>(word >> 8);
+					item.clear();
+				};
+				for (char c : rest) {
+					if (c == '\'') {
+						quoted = !quoted;
+					} else if (quoted) {
+						_memory[at++ & 0xFFFF] = static_cast<uint8_t>(c);
+					} else if (c == ',') {
+						flush();
+					} else if (!isspace(c) || !item.empty()) {
+						item += c;
+					}
+				}
+				flush();
+			} else if (pass == 1) {
+				auto instruction = decode(mnemonic, Assembly::parse(lines[i]).operands, i);
+				instruction.size = size;
+				instruction.cycles = Assembly::instructionCycles(lines[i]);
+				_instructionAt[address & 0xFFFF] = static_cast<int>(_instructions.size());
+				_instructions.push_back(instruction);
+			}
+			address += size;
+		}
+	}
+}
+
+uint8_t Emulator::get(int reg) {
+	return reg == 6 ? _memory[pair(2)] : _registers[reg];
+}
+
+void Emulator::set(int reg, uint8_t value) {
+	if (reg == 6) {
+		_memory[pair(2)] = value;
+	} else {
+		_registers[reg] = value;
+	}
+}
+
+uint16_t Emulator::pair(int reg) const {
+	if (reg == 3) return _sp;
+	return static_cast<uint16_t>(_registers[2 * reg] << 8 | _registers[2 * reg + 1]);
+}
+
+void Emulator::setPair(int reg, uint16_t value) {
+	if (reg == 3) {
+		_sp = value;
+		return;
+	}
+	_registers[2 * reg] = static_cast<uint8_t>(value >> 8);
+	_registers[2 * reg + 1] = static_cast<uint8_t>(value);
+}
+
+void Emulator::push(uint16_t value) {
+	_memory[--_sp] = static_cast<uint8_t>(value >> 8);
+	_memory[--_sp] = static_cast<uint8_t>(value);
+}
+
+uint16_t Emulator::pop() {
+	uint16_t low = _memory[_sp++];
+	uint16_t high = _memory[_sp++];
+	return static_cast<uint16_t>(high << 8 | low);
+}
+
+static bool parity(uint8_t value) {
+	bool even = true;
+	for (; value; value &= value - 1) even = !even;
+	return even;
+}
+
+void Emulator::arithmetic(Opcode opcode, uint8_t operand) {
+	int a = _registers[7];
+	int result;
+	switch (opcode) {
+		case Opcode::ADD: case Opcode::ADI:
+			result = a + operand;
+			_carry = result > 0xFF;
+			break;
+		case Opcode::ADC: case Opcode::ACI:
+			result = a + operand + _carry;
+			_carry = result > 0xFF;
+			break;
+		case Opcode::SUB: case Opcode::SUI: case Opcode::CMP: case Opcode::CPI:
+			result = a - operand;
+			_carry = result < 0;
+			break;
+		case Opcode::SBB: case Opcode::SBI:
+			result = a - operand - _carry;
+			_carry = result < 0;
+			break;
+		case Opcode::ANA: case Opcode::ANI:
+			result = a & operand;
+			_carry = false;
+			break;
+		case Opcode::XRA: case Opcode::XRI:
+			result = a ^ operand;
+			_carry = false;
+			break;
+		default:
+			result = a | operand;
+			_carry = false;
+			break;
+	}
+	auto byte = static_cast<uint8_t>(result);
+	_sign = byte & 0x80;
+	_zero = byte == 0;
+	_parity = parity(byte);
+	if (opcode != Opcode::CMP && opcode != Opcode::CPI) _registers[7] = byte;
+}
+
+bool Emulator::condition(int code) const {
+	static const bool expected[] = {false, true, false, true, false, true, false, true};
+	bool flag = code < 2 ? _zero : code < 4 ? _carry : code < 6 ? _parity : _sign;
+	return flag == expected[code];
+}
+
+void Emulator::helper(const std::string& name, std::ostream& output) {
+	// C = A * D and C = A / D on signed bytes, @PRINT writes the string at HL
+	auto a = static_cast<int8_t>(_registers[7]);
+	auto d = static_cast<int8_t>(_registers[2]);
+	if (name == "@MULT") {
+		_registers[1] = static_cast<uint8_t>(a * d);
+	} else if (name == "@DIV") {
+		_registers[1] = static_cast<uint8_t>(d == 0 ? 0 : a / d);
+	} else {
+		for (uint16_t address = pair(2); _memory[address] != 0; address++) output << _memory[address];
+		output << std::endl;
+	}
+}
+
+size_t Emulator::run(std::istream& input, std::ostream& output, const Tracer& tracer, size_t limit) {
+	_pc = 0;
+	_sp = 0;
+	size_t steps = 0;
+	// the code of the functions may follow END, only the return of the prolog call stops the run
+	while (static_cast<long>(_pc) != _end || _sp != 0) {
+		if (steps++ >= limit) throw EmulationException("Instruction limit exceeded");
+		int index = _instructionAt[_pc];
+		if (index < 0) throw EmulationException("No instruction at address " + std::to_string(_pc));
+		const auto& instruction = _instructions[index];
+		auto next = static_cast<uint16_t>(_pc + instruction.size);
+		size_t cycles = instruction.cycles;
+		switch (instruction.opcode) {
+			case Opcode::MOV:
+				set(instruction.first, get(instruction.second));
+				break;
+			case Opcode::MVI:
+				set(instruction.first, static_cast<uint8_t>(instruction.value));
+				break;
+			case Opcode::LXI:
+				setPair(instruction.first, instruction.value);
+				break;
+			case Opcode::LDA:
+				_registers[7] = _memory[instruction.value];
+				break;
+			case Opcode::STA:
+				_memory[instruction.value] = _registers[7];
+				break;
+			case Opcode::LHLD:
+				_registers[5] = _memory[instruction.value];
+				_registers[4] = _memory[static_cast<uint16_t>(instruction.value + 1)];
+				break;
+			case Opcode::SHLD:
+				_memory[instruction.value] = _registers[5];
+				_memory[static_cast<uint16_t>(instruction.value + 1)] = _registers[4];
+				break;
+			case Opcode::LDAX:
+				_registers[7] = _memory[pair(instruction.first)];
+				break;
+			case Opcode::STAX:
+				_memory[pair(instruction.first)] = _registers[7];
+				break;
+			case Opcode::XCHG: {
+				auto hl = pair(2);
+				setPair(2, pair(1));
+				setPair(1, hl);
+				break;
+			}
+			case Opcode::XTHL: {
+				auto top = pop();
+				push(pair(2));
+				setPair(2, top);
+				break;
+			}
+			case Opcode::SPHL:
+				_sp = pair(2);
+				break;
+			case Opcode::PCHL:
+				next = pair(2);
+				break;
+			case Opcode::ADD: case Opcode::ADC: case Opcode::SUB: case Opcode::SBB: case Opcode::ANA:
+			case Opcode::XRA: case Opcode::ORA: case Opcode::CMP:
+				arithmetic(instruction.opcode, get(instruction.first));
+				break;
+			case Opcode::ADI: case Opcode::ACI: case Opcode::SUI: case Opcode::SBI: case Opcode::ANI:
+			case Opcode::XRI: case Opcode::ORI: case Opcode::CPI:
+				arithmetic(instruction.opcode, static_cast<uint8_t>(instruction.value));
+				break;
+			case Opcode::INR: case Opcode::DCR: {
+				auto byte = static_cast<uint8_t>(get(instruction.first) + (instruction.opcode == Opcode::INR ? 1 : -1));
+				set(instruction.first, byte);
+				_sign = byte & 0x80;
+				_zero = byte == 0;
+				_parity = parity(byte);
+				break;
+			}
+			case Opcode::INX:
+				setPair(instruction.first, static_cast<uint16_t>(pair(instruction.first) + 1));
+				break;
+			case Opcode::DCX:
+				setPair(instruction.first, static_cast<uint16_t>(pair(instruction.first) - 1));
+				break;
+			case Opcode::DAD: {
+				unsigned sum = pair(2) + pair(instruction.first);
+				_carry = sum > 0xFFFF;
+				setPair(2, static_cast<uint16_t>(sum));
+				break;
+			}
+			case Opcode::RLC: {
+				uint8_t a = _registers[7];
+				_carry = a & 0x80;
+				_registers[7] = static_cast<uint8_t>(a << 1 | _carry);
+				break;
+			}
+			case Opcode::RRC: {
+				uint8_t a = _registers[7];
+				_carry = a & 1;
+				_registers[7] = static_cast<uint8_t>(a >> 1 | _carry << 7);
+				break;
+			}
+			case Opcode::RAL: {
+				uint8_t a = _registers[7];
+				_registers[7] = static_cast<uint8_t>(a << 1 | _carry);
+				_carry = a & 0x80;
+				break;
+			}
+			case Opcode::RAR: {
+				uint8_t a = _registers[7];
+				_registers[7] = static_cast<uint8_t>(a >> 1 | _carry << 7);
+				_carry = a & 1;
+				break;
+			}
+			case Opcode::CMA:
+				_registers[7] = static_cast<uint8_t>(~_registers[7]);
+				break;
+			case Opcode::CMC:
+				_carry = !_carry;
+				break;
+			case Opcode::STC:
+				_carry = true;
+				break;
+			case Opcode::JMP:
+				next = instruction.value;
+				break;
+			case Opcode::JCC:
+				if (condition(instruction.first)) next = instruction.value;
+				break;
+			case Opcode::CALL:
+				push(next);
+				next = instruction.value;
+				break;
+			case Opcode::CCC:
+				if (condition(instruction.first)) {
+					push(next);
+					next = instruction.value;
+				} else {
+					cycles = 11;
+				}
+				break;
+			case Opcode::RET:
+				next = pop();
+				break;
+			case Opcode::RCC:
+				if (condition(instruction.first)) {
+					next = pop();
+				} else {
+					cycles = 5;
+				}
+				break;
+			case Opcode::RST:
+				push(next);
+				next = static_cast<uint16_t>(8 * instruction.value);
+				break;
+			case Opcode::PUSH:
+				if (instruction.first == 3) {
+					push(static_cast<uint16_t>(_registers[7] << 8 | _sign << 7 | _zero << 6 | _parity << 2 | 2 | _carry));
+				} else {
+					push(pair(instruction.first));
+				}
+				break;
+			case Opcode::POP: {
+				auto word = pop();
+				if (instruction.first == 3) {
+					_registers[7] = static_cast<uint8_t>(word >> 8);
+					_sign = word & 0x80;
+					_zero = word & 0x40;
+					_parity = word & 0x04;
+					_carry = word & 0x01;
+				} else {
+					setPair(instruction.first, word);
+				}
+				break;
+			}
+			case Opcode::IN: {
+				int number = 0;
+				if (instruction.value == 0 && !(input >> number)) number = 0;
+				_registers[7] = static_cast<uint8_t>(number);
+				break;
+			}
+			case Opcode::OUT:
+				if (instruction.value == 1) {
+					output << static_cast<int>(static_cast<int8_t>(_registers[7])) << std::endl;
+				} else {
+					_ports[instruction.value] += static_cast<char>(_registers[7]);
+				}
+				break;
+			case Opcode::HELPER:
+				// only the CALL itself is counted, the helper bodies are not part of the emitted code
+				helper(instruction.helper, output);
+				if (instruction.first) next = pop();
+				break;
+			case Opcode::HLT:
+				if (tracer) tracer(instruction.line, cycles);
+				return steps;
+			default:
+				break;
+		}
+		_pc = next;
+		if (tracer) tracer(instruction.line, cycles);
+	}
+	return steps;
+}
+
+uint16_t Emulator::address(const std::string& label) const {
+	return value(label, 0);
+}
+
+uint8_t Emulator::memory(uint16_t address) const {
+	return _memory[address];
+}
+
+std::string Emulator::portOutput(int port) const {
+	auto it = _ports.find(port);
+	return it == _ports.end() ? "" : it->second;
+}
+
+EmulationException::EmulationException(std::string error) : _error(std::move(error)) {}
+
+const char *EmulationException::what() const noexcept {
+	return _error.c_str();
+}
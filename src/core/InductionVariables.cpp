@@ -0,0 +1,152 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <map>
+#include <set>
+#include "../include/InductionVariables.h"
+#include "../include/ConstantPropagation.h"
+
+static bool stepOf(const std::shared_ptr<BinaryOpAtom>& atom, size_t index, int& step) {
+	// (ADD v, c, x), (ADD c, v, x) or (SUB v, c, x)
+	auto left = std::dynamic_pointer_cast<MemoryOperand>(atom->left());
+	auto right = std::dynamic_pointer_cast<MemoryOperand>(atom->right());
+	auto leftNumber = std::dynamic_pointer_cast<NumberOperand>(atom->left());
+	auto rightNumber = std::dynamic_pointer_cast<NumberOperand>(atom->right());
+	if (atom->name() == "ADD" && left && left->index() == index && rightNumber) {
+		step = rightNumber->value();
+	} else if (atom->name() == "ADD" && right && right->index() == index && leftNumber) {
+		step = leftNumber->value();
+	} else if (atom->name() == "SUB" && left && left->index() == index && rightNumber) {
+		step = -rightNumber->value();
+	} else {
+		return false;
+	}
+	step = ConstantPropagation::normalize(step);
+	return step != 0;
+}
+
+static bool isVariable(const std::shared_ptr<RValue>& operand, size_t index) {
+	auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+	return memory && memory->index() == index;
+}
+
+InductionVariables::InductionVariables(SymbolTable& symbolTable, Scope scope)
+		: _symbolTable(symbolTable), _scope(scope) {}
+
+std::vector<InductionVariables::Variable>
+InductionVariables::find(const ControlFlowGraph& graph, const Loop& loop, const SymbolTable& symbolTable) {
+	// basic induction variables: locals written once in the loop, by v = v + c
+	// either directly or through a temp that is then copied into v
+	std::map<size_t, size_t> definitions;
+	for (size_t block : loop.blocks) {
+		for (const auto& atom : graph[block].atoms) {
+			if (auto def = atom->def()) definitions[def->index()]++;
+		}
+	}
+	std::vector<Variable> out;
+	for (size_t block : loop.blocks) {
+		const auto& atoms = graph[block].atoms;
+		for (size_t i = 0; i < atoms.size(); i++) {
+			auto def = atoms[i]->def();
+			if (!def || definitions[def->index()] != 1) continue;
+			size_t index = def->index();
+			if (symbolTable._records[index]._scope == GLOBAL_SCOPE) continue;
+			int step;
+			if (auto binary = std::dynamic_pointer_cast<BinaryOpAtom>(atoms[i])) {
+				if (stepOf(binary, index, step)) out.push_back({index, -1, step, block, i});
+				continue;
+			}
+			auto move = std::dynamic_pointer_cast<UnaryOpAtom>(atoms[i]);
+			auto source = move && move->name() == "MOV" ? std::dynamic_pointer_cast<MemoryOperand>(move->operand())
+			                                            : nullptr;
+			if (!source || definitions[source->index()] != 1) continue;
+			for (size_t j = 0; j < i; j++) {
+				auto binary = std::dynamic_pointer_cast<BinaryOpAtom>(atoms[j]);
+				if (binary && binary->result()->index() == source->index() && stepOf(binary, index, step)) {
+					out.push_back({index, int64_t(source->index()), step, block, i});
+				}
+			}
+		}
+	}
+	return out;
+}
+
+bool InductionVariables::reduce(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// (MUL v, k, t) becomes (MOV r,, t), where r = v * k is set up before the loop
+	// and stepped by c * k right after every v = v + c
+	ControlFlowGraph graph(atoms);
+	for (const auto& loop : graph.loops()) {
+		if (!graph.hasPreheaderSlot(loop)) continue;
+		auto variables = find(graph, loop, _symbolTable);
+		if (variables.empty()) continue;
+		bool hasCall = false;
+		std::set<size_t> defined;
+		for (size_t block : loop.blocks) {
+			for (const auto& atom : graph[block].atoms) {
+				if (std::dynamic_pointer_cast<CallAtom>(atom)) hasCall = true;
+				if (auto def = atom->def()) defined.insert(def->index());
+			}
+		}
+		for (size_t block : loop.blocks) {
+			for (size_t i = 0; i < graph[block].atoms.size(); i++) {
+				auto multiplication = std::dynamic_pointer_cast<BinaryOpAtom>(graph[block].atoms[i]);
+				if (!multiplication || multiplication->name() != "MUL") continue;
+				for (const auto& variable : variables) {
+					std::shared_ptr<RValue> factor;
+					if (isVariable(multiplication->left(), variable.index)) {
+						factor = multiplication->right();
+					} else if (isVariable(multiplication->right(), variable.index)) {
+						factor = multiplication->left();
+					} else {
+						continue;
+					}
+					std::string operation;
+					std::shared_ptr<RValue> increment;
+					if (auto number = std::dynamic_pointer_cast<NumberOperand>(factor)) {
+						int value = ConstantPropagation::normalize(variable.step * number->value());
+						if (value == 0) continue;
+						operation = value > 0 ? "ADD" : "SUB";
+						increment = std::make_shared<NumberOperand>(value > 0 ? value : -value);
+					} else {
+						auto memory = std::dynamic_pointer_cast<MemoryOperand>(factor);
+						bool global = _symbolTable._records[memory->index()]._scope == GLOBAL_SCOPE;
+						if (defined.count(memory->index()) || (hasCall && global)) continue;
+						if (variable.step != 1 && variable.step != -1) continue;
+						operation = variable.step == 1 ? "ADD" : "SUB";
+						increment = memory;
+					}
+					auto reduced = _symbolTable.alloc(_scope);
+					std::vector<std::shared_ptr<Atom>> out;
+					for (size_t other = 0; other < graph.size(); other++) {
+						if (other == loop.header) {
+							out.push_back(std::make_shared<BinaryOpAtom>("MUL", multiplication->left(),
+							                                             multiplication->right(), reduced));
+						}
+						for (size_t j = 0; j < graph[other].atoms.size(); j++) {
+							if (other == block && j == i) {
+								out.push_back(std::make_shared<UnaryOpAtom>("MOV", reduced, multiplication->result()));
+							} else {
+								out.push_back(graph[other].atoms[j]);
+							}
+							if (other == variable.block && j == variable.position) {
+								out.push_back(std::make_shared<BinaryOpAtom>(operation, reduced, increment, reduced));
+							}
+						}
+					}
+					atoms = out;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+bool InductionVariables::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	bool changed = false;
+	while (reduce(atoms)) {
+		changed = true;
+	}
+	return changed;
+}
@@ -0,0 +1,106 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/Inliner.h"
+#include "../include/Remapper.h"
+#include "../include/Translator.h"
+
+Inliner::Inliner(std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms, SymbolTable& symbolTable,
+                 Translator& translator, size_t budget)
+		: _atoms(atoms), _symbolTable(symbolTable), _translator(translator), _budget(budget) {}
+
+size_t Inliner::cost(const std::vector<std::shared_ptr<Atom>>& atoms) {
+	// labels and PARAMs emit no code
+	size_t count = 0;
+	for (const auto& atom : atoms) {
+		if (!std::dynamic_pointer_cast<LabelAtom>(atom) && !std::dynamic_pointer_cast<ParamAtom>(atom)) count++;
+	}
+	return count;
+}
+
+std::vector<std::shared_ptr<Atom>> Inliner::expand(Scope caller, const std::shared_ptr<CallAtom>& call,
+                                                   const std::vector<std::shared_ptr<Atom>>& params) {
+	Scope callee = call->function()->index();
+	int n = _symbolTable._records[callee]._len;
+	std::vector<std::shared_ptr<Atom>> out;
+	// every variable of the callee gets a slot in the caller frame. Parameters are copied
+	// from the arguments, named locals are zeroed as the callee prologue would do.
+	Remapper::Variables variables;
+	int position = 0;
+	for (size_t i = 0, size = _symbolTable.size(); i < size; i++) {
+		if (_symbolTable._records[i]._scope != callee ||
+		    _symbolTable._records[i]._kind != SymbolTable::TableRecord::RecordKind::var) {
+			continue;
+		}
+		bool temporary = _symbolTable._records[i]._name[0] == '!';
+		auto local = _symbolTable.alloc(caller);
+		variables[i] = local;
+		if (position < n) {
+			auto param = std::dynamic_pointer_cast<ParamAtom>(params[position]);
+			out.push_back(std::make_shared<UnaryOpAtom>("MOV", param->value(), local));
+		} else if (!temporary) {
+			out.push_back(std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(0), local));
+		}
+		position++;
+	}
+	const auto& body = _atoms[callee];
+	Remapper::Labels labels;
+	for (const auto& atom : body) {
+		if (auto label = std::dynamic_pointer_cast<LabelAtom>(atom)) {
+			labels[label->label()->labelId()] = _translator.newLabel();
+		}
+	}
+	auto end = _translator.newLabel();
+	for (size_t i = 0; i < body.size(); i++) {
+		if (auto ret = std::dynamic_pointer_cast<RetAtom>(body[i])) {
+			out.push_back(std::make_shared<UnaryOpAtom>("MOV", Remapper::rename(ret->value(), variables), call->result()));
+			if (i + 1 < body.size()) out.push_back(std::make_shared<JumpAtom>(end));
+			continue;
+		}
+		out.push_back(Remapper::remap(body[i], variables, labels));
+	}
+	out.push_back(std::make_shared<LabelAtom>(end));
+	return out;
+}
+
+bool Inliner::inlineCalls(Scope caller, const CallGraph& graph) {
+	auto& atoms = _atoms[caller];
+	std::vector<std::shared_ptr<Atom>> out;
+	bool changed = false;
+	for (const auto& atom : atoms) {
+		auto call = std::dynamic_pointer_cast<CallAtom>(atom);
+		if (call) {
+			Scope callee = call->function()->index();
+			int n = _symbolTable._records[callee]._len;
+			auto body = _atoms.find(callee);
+			// PARAMs were moved right before their CALL, so the arguments are the last n atoms
+			bool arguments = int(out.size()) >= n;
+			for (int i = 1; arguments && i <= n; i++) {
+				arguments = bool(std::dynamic_pointer_cast<ParamAtom>(out[out.size() - i]));
+			}
+			if (arguments && body != _atoms.end() && !graph.reaches(callee, callee) &&
+			    cost(body->second) <= _budget + n) {
+				std::vector<std::shared_ptr<Atom>> params(out.end() - n, out.end());
+				out.erase(out.end() - n, out.end());
+				auto expansion = expand(caller, call, params);
+				out.insert(out.end(), expansion.begin(), expansion.end());
+				changed = true;
+				continue;
+			}
+		}
+		out.push_back(atom);
+	}
+	atoms = out;
+	return changed;
+}
+
+bool Inliner::run() {
+	// callees are visited before their callers, so an inlined body has its own calls inlined already
+	CallGraph graph(_atoms);
+	bool changed = false;
+	for (Scope function : graph.postorder()) {
+		changed = inlineCalls(function, graph) || changed;
+	}
+	return changed;
+}
@@ -0,0 +1,151 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include "../include/InterproceduralConstants.h"
+#include "../include/ConstantPropagation.h"
+#include "../include/ControlFlowGraph.h"
+#include "../include/Inliner.h"
+#include "../include/Remapper.h"
+#include "../include/Translator.h"
+
+InterproceduralConstants::InterproceduralConstants(std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms,
+                                                   SymbolTable& symbolTable, Translator& translator, size_t budget)
+		: _atoms(atoms), _symbolTable(symbolTable), _translator(translator), _budget(budget) {}
+
+std::vector<size_t> InterproceduralConstants::parameterRecords(Scope function) const {
+	std::vector<size_t> records;
+	int n = _symbolTable._records[function]._len;
+	for (size_t i = 0; i < _symbolTable.size() && int(records.size()) < n; i++) {
+		const auto& record = _symbolTable._records[i];
+		if (record._scope == function && record._kind == SymbolTable::TableRecord::RecordKind::var) {
+			records.push_back(i);
+		}
+	}
+	return records;
+}
+
+std::map<Scope, std::vector<InterproceduralConstants::CallSite>> InterproceduralConstants::callSites() const {
+	std::map<Scope, std::vector<CallSite>> sites;
+	for (const auto& pair : _atoms) {
+		const auto& atoms = pair.second;
+		ControlFlowGraph graph(atoms);
+		std::vector<bool> inLoop(graph.size(), false);
+		for (const auto& loop : graph.loops()) {
+			for (size_t block : loop.blocks) inLoop[block] = true;
+		}
+		size_t block = 0;
+		size_t end = graph.size() > 0 ? graph[0].atoms.size() : 0;
+		for (size_t i = 0; i < atoms.size(); i++) {
+			while (i >= end) end += graph[++block].atoms.size();
+			auto call = std::dynamic_pointer_cast<CallAtom>(atoms[i]);
+			if (!call) continue;
+			Scope callee = call->function()->index();
+			int n = _symbolTable._records[callee]._len;
+			CallSite site = {pair.first, i, std::vector<int>(n, -1), inLoop[block]};
+			// PARAMs were moved right before their CALL, otherwise nothing is known about the arguments
+			for (int k = 0; k < n && int(i) >= n; k++) {
+				auto param = std::dynamic_pointer_cast<ParamAtom>(atoms[i - n + k]);
+				if (!param) {
+					site.arguments.assign(n, -1);
+					break;
+				}
+				auto number = std::dynamic_pointer_cast<NumberOperand>(param->value());
+				if (number) site.arguments[k] = ConstantPropagation::normalize(number->value());
+			}
+			sites[callee].push_back(site);
+		}
+	}
+	return sites;
+}
+
+std::shared_ptr<MemoryOperand> InterproceduralConstants::clone(Scope function) {
+	auto record = _symbolTable._records[function];
+	auto operand = _symbolTable.addFunc(record._name + "@" + std::to_string(++_clones[function]), record._type,
+	                                    record._len);
+	Remapper::Variables variables;
+	for (size_t i = 0, size = _symbolTable.size(); i < size; i++) {
+		auto variable = _symbolTable._records[i];
+		if (variable._scope != function || variable._kind != SymbolTable::TableRecord::RecordKind::var) continue;
+		variables[i] = _symbolTable.addVar(variable._name, Scope(operand->index()), variable._type, variable._init);
+	}
+	const auto& body = _atoms[function];
+	Remapper::Labels labels;
+	for (const auto& atom : body) {
+		if (auto label = std::dynamic_pointer_cast<LabelAtom>(atom)) {
+			labels[label->label()->labelId()] = _translator.newLabel();
+		}
+	}
+	std::vector<std::shared_ptr<Atom>> out;
+	for (const auto& atom : body) {
+		out.push_back(Remapper::remap(atom, variables, labels));
+	}
+	_atoms[Scope(operand->index())] = out;
+	return operand;
+}
+
+std::set<Scope> InterproceduralConstants::specialize(const std::map<Scope, std::vector<CallSite>>& sites) {
+	// a function called with several constant tuples gets a copy for each hot one. A tuple is hot
+	// when it is passed from a loop or from more than one place.
+	std::set<Scope> clones;
+	for (const auto& pair : sites) {
+		auto body = _atoms.find(pair.first);
+		if (body == _atoms.end() || Inliner::cost(body->second) > _budget) continue;
+		std::map<std::vector<int>, std::vector<const CallSite*>> tuples;
+		for (const auto& site : pair.second) tuples[site.arguments].push_back(&site);
+		if (tuples.size() < 2) continue;
+		std::vector<std::pair<size_t, std::vector<int>>> hot;
+		for (const auto& tuple : tuples) {
+			if (std::all_of(tuple.first.begin(), tuple.first.end(), [](int value) { return value == -1; })) continue;
+			size_t weight = 0;
+			for (const auto *site : tuple.second) weight += site->inLoop ? 8 : 1;
+			if (weight >= 2) hot.emplace_back(weight, tuple.first);
+		}
+		std::stable_sort(hot.begin(), hot.end(), [](const std::pair<size_t, std::vector<int>>& a,
+		                                            const std::pair<size_t, std::vector<int>>& b) {
+			return a.first > b.first;
+		});
+		if (hot.size() > 2) hot.resize(2);
+		for (const auto& tuple : hot) {
+			auto function = clone(pair.first);
+			for (const auto *site : tuples[tuple.second]) {
+				auto& atom = _atoms[site->caller][site->position];
+				auto call = std::dynamic_pointer_cast<CallAtom>(atom);
+				atom = std::make_shared<CallAtom>(function, call->result());
+			}
+			clones.insert(Scope(function->index()));
+		}
+	}
+	return clones;
+}
+
+std::set<Scope> InterproceduralConstants::run() {
+	// a parameter that gets the same constant from every call site is that constant on entry
+	std::set<Scope> changed;
+	auto sites = callSites();
+	if (_budget > 0 && !_specialized) {
+		_specialized = true;
+		changed = specialize(sites);
+		if (!changed.empty()) sites = callSites();
+	}
+	for (const auto& pair : sites) {
+		auto records = parameterRecords(pair.first);
+		auto& parameters = _parameters[pair.first];
+		for (size_t k = 0; k < records.size(); k++) {
+			int value = pair.second.front().arguments[k];
+			bool uniform = value != -1;
+			for (const auto& site : pair.second) uniform = uniform && site.arguments[k] == value;
+			if (uniform && !parameters.count(records[k])) {
+				parameters[records[k]] = value;
+				changed.insert(pair.first);
+			}
+		}
+	}
+	return changed;
+}
+
+const InterproceduralConstants::Parameters& InterproceduralConstants::parameters(Scope function) const {
+	auto it = _parameters.find(function);
+	return it == _parameters.end() ? _none : it->second;
+}
@@ -0,0 +1,216 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <set>
+#include "../include/JumpThreading.h"
+
+std::shared_ptr<LabelOperand> JumpThreading::target(const std::shared_ptr<Atom>& atom) {
+	if (auto jump = std::dynamic_pointer_cast<JumpAtom>(atom)) {
+		return jump->label();
+	}
+	if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom)) {
+		return conditionalJump->label();
+	}
+	return nullptr;
+}
+
+std::shared_ptr<Atom>
+JumpThreading::retarget(const std::shared_ptr<Atom>& atom, const std::shared_ptr<LabelOperand>& label) {
+	if (std::dynamic_pointer_cast<JumpAtom>(atom)) {
+		return std::make_shared<JumpAtom>(label);
+	}
+	auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom);
+	return std::make_shared<ConditionalJumpAtom>(conditionalJump->condition(), conditionalJump->left(),
+	                                             conditionalJump->right(), label);
+}
+
+int JumpThreading::labelOf(const std::shared_ptr<Atom>& atom) {
+	auto label = std::dynamic_pointer_cast<LabelAtom>(atom);
+	return label ? label->label()->labelId() : -1;
+}
+
+bool JumpThreading::mergeLabels(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// (LBL a) (LBL b): every jump to b goes to a instead, b is dropped
+	std::map<int, std::shared_ptr<LabelOperand>> aliases;
+	std::vector<std::shared_ptr<Atom>> out;
+	std::shared_ptr<LabelOperand> previous;
+	for (const auto& atom : atoms) {
+		auto label = std::dynamic_pointer_cast<LabelAtom>(atom);
+		if (label && previous) {
+			aliases[label->label()->labelId()] = previous;
+			continue;
+		}
+		previous = label ? label->label() : nullptr;
+		out.push_back(atom);
+	}
+	if (aliases.empty()) return false;
+	for (auto& atom : out) {
+		if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+			atom = switchAtom->retarget(aliases);
+			continue;
+		}
+		auto label = target(atom);
+		if (!label) continue;
+		auto alias = aliases.find(label->labelId());
+		if (alias != aliases.end()) {
+			atom = retarget(atom, alias->second);
+		}
+	}
+	atoms = out;
+	return true;
+}
+
+bool JumpThreading::threadJumps(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// a jump whose target label is followed by (JMP m) goes to m directly
+	std::map<int, std::shared_ptr<LabelOperand>> forwards;
+	for (size_t i = 0; i + 1 < atoms.size(); i++) {
+		auto jump = std::dynamic_pointer_cast<JumpAtom>(atoms[i + 1]);
+		if (labelOf(atoms[i]) != -1 && jump) {
+			forwards[labelOf(atoms[i])] = jump->label();
+		}
+	}
+	auto resolve = [&forwards](const std::shared_ptr<LabelOperand>& label) {
+		auto final = label;
+		std::set<int> visited = {final->labelId()};
+		auto it = forwards.find(final->labelId());
+		bool cycle = false;
+		while (it != forwards.end() && !cycle) {
+			final = it->second;
+			cycle = !visited.insert(final->labelId()).second;
+			it = forwards.find(final->labelId());
+		}
+		return cycle ? label : final;
+	};
+	bool changed = false;
+	for (auto& atom : atoms) {
+		if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+			std::map<int, std::shared_ptr<LabelOperand>> threaded;
+			for (const auto& label : switchAtom->labels()) {
+				auto final = resolve(label);
+				if (final->labelId() != label->labelId()) threaded[label->labelId()] = final;
+			}
+			if (!threaded.empty()) {
+				atom = switchAtom->retarget(threaded);
+				changed = true;
+			}
+			continue;
+		}
+		auto label = target(atom);
+		if (!label) continue;
+		auto final = resolve(label);
+		if (final->labelId() != label->labelId()) {
+			atom = retarget(atom, final);
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+bool JumpThreading::removeFallthroughJumps(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// a jump to one of the labels right after it does nothing
+	bool changed = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t i = 0; i < atoms.size(); i++) {
+		auto label = target(atoms[i]);
+		if (label) {
+			bool fallthrough = false;
+			for (size_t j = i + 1; j < atoms.size() && labelOf(atoms[j]) != -1; j++) {
+				if (labelOf(atoms[j]) == label->labelId()) {
+					fallthrough = true;
+					break;
+				}
+			}
+			if (fallthrough) {
+				changed = true;
+				continue;
+			}
+		}
+		out.push_back(atoms[i]);
+	}
+	if (changed) atoms = out;
+	return changed;
+}
+
+bool JumpThreading::invertJumpsOverJumps(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// (cond, a, b, L1) (JMP L2) (LBL L1) -> (!cond, a, b, L2) (LBL L1)
+	bool changed = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t i = 0; i < atoms.size(); i++) {
+		if (i + 2 < atoms.size()) {
+			auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms[i]);
+			auto jump = std::dynamic_pointer_cast<JumpAtom>(atoms[i + 1]);
+			if (conditionalJump && jump && labelOf(atoms[i + 2]) == conditionalJump->label()->labelId()) {
+				out.push_back(std::make_shared<ConditionalJumpAtom>(
+						ConditionalJumpAtom::invertCondition(conditionalJump->condition()),
+						conditionalJump->left(), conditionalJump->right(), jump->label()));
+				changed = true;
+				i++;
+				continue;
+			}
+		}
+		out.push_back(atoms[i]);
+	}
+	if (changed) atoms = out;
+	return changed;
+}
+
+bool JumpThreading::removeDeadCode(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// nothing after JMP, SWITCH or RET runs until the next label
+	bool changed = false;
+	bool dead = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (const auto& atom : atoms) {
+		if (labelOf(atom) != -1) {
+			dead = false;
+		} else if (dead) {
+			changed = true;
+			continue;
+		}
+		out.push_back(atom);
+		if (std::dynamic_pointer_cast<JumpAtom>(atom) || std::dynamic_pointer_cast<SwitchAtom>(atom) ||
+		    std::dynamic_pointer_cast<RetAtom>(atom) || std::dynamic_pointer_cast<TailCallAtom>(atom)) {
+			dead = true;
+		}
+	}
+	if (changed) atoms = out;
+	return changed;
+}
+
+bool JumpThreading::removeUnusedLabels(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	std::set<int> referenced;
+	for (const auto& atom : atoms) {
+		auto label = target(atom);
+		if (label) referenced.insert(label->labelId());
+		if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+			for (const auto& switchLabel : switchAtom->labels()) referenced.insert(switchLabel->labelId());
+		}
+	}
+	bool changed = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (const auto& atom : atoms) {
+		int label = labelOf(atom);
+		if (label != -1 && !referenced.count(label)) {
+			changed = true;
+			continue;
+		}
+		out.push_back(atom);
+	}
+	if (changed) atoms = out;
+	return changed;
+}
+
+bool JumpThreading::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	bool changed = false;
+	bool iteration = true;
+	while (iteration) {
+		iteration = mergeLabels(atoms);
+		iteration |= threadJumps(atoms);
+		iteration |= removeFallthroughJumps(atoms);
+		iteration |= invertJumpsOverJumps(atoms);
+		iteration |= removeDeadCode(atoms);
+		iteration |= removeUnusedLabels(atoms);
+		changed |= iteration;
+	}
+	return changed;
+}
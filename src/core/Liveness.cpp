@@ -0,0 +1,78 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/Liveness.h"
+
+Liveness::Liveness(const SymbolTable& symbolTable, const ControlFlowGraph& graph)
+		: _globals(symbolTable._records.size()) {
+	size_t width = symbolTable._records.size();
+	for (size_t i = 0; i < width; i++) {
+		const auto& record = symbolTable._records[i];
+		if (record._scope == GLOBAL_SCOPE && record._kind == SymbolTable::TableRecord::RecordKind::var) _globals.set(i);
+	}
+	Dataflow::Problem problem;
+	problem.direction = Dataflow::Direction::backward;
+	problem.meet = Dataflow::Meet::unite;
+	problem.width = width;
+	// globals outlive the function
+	problem.boundary = _globals;
+	for (size_t block = 0; block < graph.size(); block++) {
+		Bitset gen(width);
+		Bitset kill(width);
+		const auto& atoms = graph[block].atoms;
+		for (auto it = atoms.rbegin(); it != atoms.rend(); ++it) {
+			if (auto def = (*it)->def()) {
+				kill.set(def->index());
+				gen.reset(def->index());
+			}
+			Bitset uses(width);
+			transfer(*it, uses);
+			gen.unite(uses);
+		}
+		problem.gen.push_back(gen);
+		problem.kill.push_back(kill);
+	}
+	Dataflow dataflow(graph, problem);
+	for (size_t block = 0; block < graph.size(); block++) {
+		_blockIn.push_back(dataflow.in(block));
+		_blockOut.push_back(dataflow.out(block));
+		const auto& atoms = graph[block].atoms;
+		std::vector<Bitset> atomIn(atoms.size());
+		Bitset live = _blockOut.back();
+		for (size_t i = atoms.size(); i-- > 0;) {
+			if (auto def = atoms[i]->def()) live.reset(def->index());
+			transfer(atoms[i], live);
+			atomIn[i] = live;
+		}
+		_atomIn.push_back(atomIn);
+	}
+}
+
+void Liveness::transfer(const std::shared_ptr<Atom>& atom, Bitset& live) const {
+	// adds the variables read by the atom. The callee of a CALL and the caller after a RET
+	// may read any global.
+	for (const auto& use : atom->uses()) {
+		if (auto memory = std::dynamic_pointer_cast<MemoryOperand>(use)) live.set(memory->index());
+	}
+	if (std::dynamic_pointer_cast<CallAtom>(atom) || std::dynamic_pointer_cast<TailCallAtom>(atom) ||
+	    std::dynamic_pointer_cast<RetAtom>(atom)) {
+		live.unite(_globals);
+	}
+}
+
+const Bitset& Liveness::liveIn(size_t block) const {
+	return _blockIn[block];
+}
+
+const Bitset& Liveness::liveOut(size_t block) const {
+	return _blockOut[block];
+}
+
+const Bitset& Liveness::liveIn(size_t block, size_t atom) const {
+	return _atomIn[block][atom];
+}
+
+const Bitset& Liveness::liveOut(size_t block, size_t atom) const {
+	return atom + 1 < _atomIn[block].size() ? _atomIn[block][atom + 1] : _blockOut[block];
+}
@@ -0,0 +1,168 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <set>
+#include "../include/LoopInvariantCodeMotion.h"
+
+static bool dominatesAll(const std::vector<std::vector<bool>>& dominators, size_t block,
+                         const std::vector<size_t>& blocks) {
+	return std::all_of(blocks.begin(), blocks.end(), [&](size_t other) { return dominators[other][block]; });
+}
+
+static bool dominatesUses(const ControlFlowGraph& graph, const std::vector<std::vector<bool>>& dominators,
+                          const Loop& loop, size_t block, size_t position, size_t index) {
+	for (size_t other : loop.blocks) {
+		const auto& atoms = graph[other].atoms;
+		for (size_t i = 0; i < atoms.size(); i++) {
+			for (const auto& use : atoms[i]->uses()) {
+				auto memory = std::dynamic_pointer_cast<MemoryOperand>(use);
+				if (!memory || memory->index() != index) continue;
+				if (other == block ? i <= position : !dominators[other][block]) return false;
+			}
+		}
+	}
+	return true;
+}
+
+LoopInvariantCodeMotion::LoopInvariantCodeMotion(const SymbolTable& symbolTable, const SideEffects& sideEffects,
+                                                 std::map<int, size_t>& hoisted)
+		: _symbolTable(symbolTable), _sideEffects(sideEffects), _hoisted(hoisted) {}
+
+bool LoopInvariantCodeMotion::isGlobal(const std::shared_ptr<MemoryOperand>& operand) const {
+	return _symbolTable._records[operand->index()]._scope == GLOBAL_SCOPE;
+}
+
+std::vector<LoopInvariantCodeMotion::Position>
+LoopInvariantCodeMotion::findInvariants(const ControlFlowGraph& graph, const std::vector<std::vector<bool>>& dominators,
+                                        const Loop& loop) const {
+	std::vector<Position> out;
+	std::vector<bool> inLoop(graph.size(), false);
+	for (size_t block : loop.blocks) inLoop[block] = true;
+	if (!graph.hasPreheaderSlot(loop)) return out;
+
+	// a call may write globals unless its summary says otherwise, IN and CALL results count as definitions
+	bool clobbersGlobals = false;
+	bool writesGlobals = false;
+	std::map<size_t, size_t> definitions;
+	std::set<size_t> usedOutside;
+	std::vector<size_t> exits;
+	for (size_t block = 0; block < graph.size(); block++) {
+		for (const auto& atom : graph[block].atoms) {
+			if (inLoop[block]) {
+				if (std::dynamic_pointer_cast<CallAtom>(atom) && _sideEffects.of(atom).writesGlobals) {
+					clobbersGlobals = true;
+				}
+				if (auto def = atom->def()) {
+					definitions[def->index()]++;
+					if (isGlobal(def)) writesGlobals = true;
+				}
+			} else {
+				for (const auto& use : atom->uses()) {
+					if (auto memory = std::dynamic_pointer_cast<MemoryOperand>(use)) usedOutside.insert(memory->index());
+				}
+			}
+		}
+		if (inLoop[block]) {
+			for (size_t successor : graph[block].successors) {
+				if (!inLoop[successor]) {
+					exits.push_back(block);
+					break;
+				}
+			}
+		}
+	}
+
+	std::set<Position> hoisted;
+	std::set<size_t> hoistedDefinitions;
+	auto invariant = [&](const std::shared_ptr<RValue>& operand) {
+		auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+		if (!memory) return true;
+		if (clobbersGlobals && isGlobal(memory)) return false;
+		return definitions.count(memory->index()) == 0 || hoistedDefinitions.count(memory->index()) != 0;
+	};
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (size_t block : loop.blocks) {
+			const auto& atoms = graph[block].atoms;
+			for (size_t i = 0; i < atoms.size(); i++) {
+				const auto& atom = atoms[i];
+				if (hoisted.count({block, i})) continue;
+				// a read-only call moves together with the PARAMs right before it
+				auto call = std::dynamic_pointer_cast<CallAtom>(atom);
+				size_t arguments = 0;
+				auto uses = atom->uses();
+				if (call) {
+					const auto& effects = _sideEffects.of(atom);
+					if (!effects.isReadOnly()) continue;
+					if (!effects.isPure() && (clobbersGlobals || writesGlobals)) continue;
+					arguments = _symbolTable._records[call->function()->index()]._len;
+					if (arguments > i) continue;
+					bool params = true;
+					for (size_t k = i - arguments; k < i; k++) {
+						auto param = std::dynamic_pointer_cast<ParamAtom>(atoms[k]);
+						if (!param) {
+							params = false;
+							break;
+						}
+						uses.push_back(param->value());
+					}
+					if (!params) continue;
+				} else if (!std::dynamic_pointer_cast<BinaryOpAtom>(atom) && !std::dynamic_pointer_cast<UnaryOpAtom>(atom)) {
+					continue;
+				}
+				auto result = atom->def();
+				if (isGlobal(result) || definitions[result->index()] != 1) continue;
+				if (!std::all_of(uses.begin(), uses.end(), invariant)) continue;
+				// must run on every iteration, before every use in the loop and before leaving it
+				if (!dominatesAll(dominators, block, loop.latches)) continue;
+				if (usedOutside.count(result->index()) && !dominatesAll(dominators, block, exits)) continue;
+				if (!dominatesUses(graph, dominators, loop, block, i, result->index())) continue;
+				for (size_t k = i - arguments; k <= i; k++) {
+					hoisted.insert({block, k});
+					out.emplace_back(block, k);
+				}
+				hoistedDefinitions.insert(result->index());
+				changed = true;
+			}
+		}
+	}
+	return out;
+}
+
+bool LoopInvariantCodeMotion::hoist(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	ControlFlowGraph graph(atoms);
+	auto dominators = graph.dominators();
+	for (const auto& loop : graph.loops()) {
+		auto invariants = findInvariants(graph, dominators, loop);
+		if (invariants.empty()) continue;
+		std::set<Position> moved(invariants.begin(), invariants.end());
+		std::vector<std::shared_ptr<Atom>> out;
+		for (size_t block = 0; block < graph.size(); block++) {
+			if (block == loop.header) {
+				for (const auto& position : invariants) {
+					out.push_back(graph[position.first].atoms[position.second]);
+				}
+			}
+			for (size_t i = 0; i < graph[block].atoms.size(); i++) {
+				if (!moved.count({block, i})) out.push_back(graph[block].atoms[i]);
+			}
+		}
+		atoms = out;
+		auto label = std::dynamic_pointer_cast<LabelAtom>(graph[loop.header].atoms.front());
+		_hoisted[label->label()->labelId()] += invariants.size();
+		return true;
+	}
+	return false;
+}
+
+bool LoopInvariantCodeMotion::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// inner loops come first, their preheaders are then candidates for the outer loops
+	bool changed = false;
+	while (hoist(atoms)) {
+		changed = true;
+	}
+	return changed;
+}
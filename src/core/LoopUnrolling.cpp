@@ -0,0 +1,144 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <map>
+#include "../include/LoopUnrolling.h"
+#include "../include/ConstantPropagation.h"
+#include "../include/InductionVariables.h"
+#include "../include/Remapper.h"
+#include "../include/Translator.h"
+
+LoopUnrolling::LoopUnrolling(const SymbolTable& symbolTable, Translator& translator, size_t budget)
+		: _symbolTable(symbolTable), _translator(translator), _budget(budget) {}
+
+bool LoopUnrolling::entryValue(const ControlFlowGraph& graph, const Loop& loop, size_t index, int& value) {
+	// the last write before the loop on the straight-line path into it
+	for (size_t block = loop.header; block-- > 0;) {
+		const auto& atoms = graph[block].atoms;
+		for (size_t i = atoms.size(); i-- > 0;) {
+			auto def = atoms[i]->def();
+			if (def && def->index() == index) {
+				auto move = std::dynamic_pointer_cast<UnaryOpAtom>(atoms[i]);
+				auto number = move && move->name() == "MOV" ? std::dynamic_pointer_cast<NumberOperand>(move->operand())
+				                                            : nullptr;
+				if (!number) return false;
+				value = number->value();
+				return true;
+			}
+			if (std::dynamic_pointer_cast<LabelAtom>(atoms[i])) return false;
+		}
+	}
+	return false;
+}
+
+int64_t LoopUnrolling::tripCount(const ControlFlowGraph& graph, const Loop& loop) const {
+	// the back edge must compare a basic induction variable stepped in the latch with a constant
+	size_t latch = loop.latches.front();
+	auto back = std::dynamic_pointer_cast<ConditionalJumpAtom>(graph[latch].atoms.back());
+	for (const auto& variable : InductionVariables::find(graph, loop, _symbolTable)) {
+		if (variable.block != latch) continue;
+		auto matches = [&variable](const std::shared_ptr<RValue>& operand) {
+			auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+			return memory && (memory->index() == variable.index || int64_t(memory->index()) == variable.alias);
+		};
+		auto leftNumber = std::dynamic_pointer_cast<NumberOperand>(back->left());
+		auto rightNumber = std::dynamic_pointer_cast<NumberOperand>(back->right());
+		bool variableLeft = matches(back->left()) && rightNumber;
+		if (!variableLeft && !(matches(back->right()) && leftNumber)) continue;
+		int bound = variableLeft ? rightNumber->value() : leftNumber->value();
+		int value;
+		if (!entryValue(graph, loop, variable.index, value)) continue;
+		for (int64_t count = 1; count <= 256; count++) {
+			value = ConstantPropagation::normalize(value + variable.step);
+			bool taken = variableLeft ? ConstantPropagation::compare(back->condition(), value, bound)
+			                          : ConstantPropagation::compare(back->condition(), bound, value);
+			if (!taken) return count;
+		}
+	}
+	return -1;
+}
+
+bool LoopUnrolling::unroll(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	ControlFlowGraph graph(atoms);
+	for (const auto& loop : graph.loops()) {
+		// a single bottom-tested loop laid out contiguously, left only through its back edge
+		if (loop.latches.size() != 1 || !graph.hasPreheaderSlot(loop)) continue;
+		size_t latch = loop.latches.front();
+		if (latch < loop.header || loop.blocks.size() != latch - loop.header + 1) continue;
+		auto header = std::dynamic_pointer_cast<LabelAtom>(graph[loop.header].atoms.front());
+		auto back = std::dynamic_pointer_cast<ConditionalJumpAtom>(graph[latch].atoms.back());
+		if (!back || back->label()->labelId() != header->label()->labelId()) continue;
+		bool singleExit = true;
+		size_t size = 0;
+		for (size_t block : loop.blocks) {
+			size += graph[block].atoms.size();
+			for (const auto& atom : graph[block].atoms) {
+				if (std::dynamic_pointer_cast<RetAtom>(atom)) singleExit = false;
+			}
+			if (block == latch) continue;
+			for (size_t successor : graph[block].successors) {
+				if (successor < loop.header || successor > latch) singleExit = false;
+			}
+		}
+		if (!singleExit) continue;
+		int64_t count = tripCount(graph, loop);
+		if (count <= 0) continue;
+
+		// without the header label and the back edge; a full unroll that does not grow is always taken
+		size -= 2;
+		size_t factor = 0;
+		if (size_t(count) * size <= std::max(_budget, size + 2)) {
+			factor = size_t(count);
+		} else {
+			for (size_t candidate = size_t(count) - 1; candidate >= 2; candidate--) {
+				if (count % candidate == 0 && candidate * size <= _budget) {
+					factor = candidate;
+					break;
+				}
+			}
+		}
+		if (factor == 0) continue;
+		bool full = factor == size_t(count);
+
+		std::vector<std::shared_ptr<Atom>> out;
+		for (size_t block = 0; block < loop.header; block++) {
+			out.insert(out.end(), graph[block].atoms.begin(), graph[block].atoms.end());
+		}
+		for (size_t copy = 0; copy < factor; copy++) {
+			Remapper::Labels labels;
+			for (size_t block = loop.header + 1; copy > 0 && block <= latch; block++) {
+				if (auto label = std::dynamic_pointer_cast<LabelAtom>(graph[block].atoms.front())) {
+					labels[label->label()->labelId()] = _translator.newLabel();
+				}
+			}
+			for (size_t block = loop.header; block <= latch; block++) {
+				const auto& blockAtoms = graph[block].atoms;
+				for (size_t i = 0; i < blockAtoms.size(); i++) {
+					if (block == loop.header && i == 0) {
+						if (!full && copy == 0) out.push_back(blockAtoms[i]);
+						continue;
+					}
+					if (block == latch && i + 1 == blockAtoms.size()) continue;
+					out.push_back(Remapper::remap(blockAtoms[i], {}, labels));
+				}
+			}
+		}
+		if (!full) out.push_back(back);
+		for (size_t block = latch + 1; block < graph.size(); block++) {
+			out.insert(out.end(), graph[block].atoms.begin(), graph[block].atoms.end());
+		}
+		atoms = out;
+		return true;
+	}
+	return false;
+}
+
+bool LoopUnrolling::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	bool changed = false;
+	while (unroll(atoms)) {
+		changed = true;
+	}
+	return changed;
+}
@@ -0,0 +1,110 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/Optimizer.h"
+#include "../include/BranchFusion.h"
+#include "../include/ConstantPropagation.h"
+#include "../include/GlobalParameters.h"
+#include "../include/InductionVariables.h"
+#include "../include/Inliner.h"
+#include "../include/InterproceduralConstants.h"
+#include "../include/JumpThreading.h"
+#include "../include/LoopInvariantCodeMotion.h"
+#include "../include/LoopUnrolling.h"
+#include "../include/RedundantCalls.h"
+#include "../include/SideEffects.h"
+#include "../include/StackSlots.h"
+#include "../include/TailCalls.h"
+#include "../include/Translator.h"
+
+Optimizer::Optimizer(std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms, SymbolTable& symbolTable,
+                     Translator& translator) : _atoms(atoms), _symbolTable(symbolTable), _translator(translator) {}
+
+void Optimizer::normalizeParams(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// PARAM emits no code, its operand is read by the CALL, so every PARAM can be moved
+	// right before its CALL. After that the arguments never cross a block boundary.
+	std::vector<std::shared_ptr<Atom>> out;
+	std::vector<std::shared_ptr<Atom>> pending;
+	for (const auto& atom : atoms) {
+		if (std::dynamic_pointer_cast<ParamAtom>(atom)) {
+			pending.push_back(atom);
+			continue;
+		}
+		if (auto call = std::dynamic_pointer_cast<CallAtom>(atom)) {
+			int n = _symbolTable._records[call->function()->index()]._len;
+			if (int(pending.size()) < n) {
+				throw CodeGenerationException("Not enough arguments for CALL: expected " +
+				                              std::to_string(n) + ", got " + std::to_string(pending.size()));
+			}
+			out.insert(out.end(), pending.end() - n, pending.end());
+			pending.erase(pending.end() - n, pending.end());
+		}
+		out.push_back(atom);
+	}
+	out.insert(out.end(), pending.begin(), pending.end());
+	atoms = out;
+}
+
+void Optimizer::run() {
+	const auto& parameters = GlobalParameters::getInstance();
+	if (parameters.optimizationLevel <= 0) return;
+	BranchFusion branchFusion;
+	TailCalls tailCalls(_symbolTable, _translator);
+	for (auto& pair : _atoms) {
+		normalizeParams(pair.second);
+		branchFusion.run(pair.second);
+		branchFusion.materialize(pair.second);
+		tailCalls.eliminateRecursion(pair.first, pair.second);
+	}
+	// under -Os a body is inlined only if it is not larger than the CALL and RET it replaces
+	size_t inlineBudget = parameters.optimizeForSize ? 2 : parameters.optimizationLevel >= 2 ? 32 : 16;
+	Inliner(_atoms, _symbolTable, _translator, inlineBudget).run();
+	SideEffects sideEffects(_symbolTable, _atoms);
+	ConstantPropagation constantPropagation(_symbolTable, _atoms, sideEffects);
+	JumpThreading jumpThreading;
+	for (auto& pair : _atoms) {
+		constantPropagation.run(pair.second);
+		jumpThreading.run(pair.second);
+	}
+	// a constant parameter folds the callee's arguments to its own callees, so this repeats.
+	// Functions are cloned for constant arguments only at -O2.
+	InterproceduralConstants interproceduralConstants(_atoms, _symbolTable, _translator,
+	                                                  parameters.optimizationLevel >= 2 &&
+	                                                  !parameters.optimizeForSize ? 64 : 0);
+	for (auto scopes = interproceduralConstants.run(); !scopes.empty(); scopes = interproceduralConstants.run()) {
+		for (Scope scope : scopes) {
+			constantPropagation.run(_atoms[scope], interproceduralConstants.parameters(scope));
+			jumpThreading.run(_atoms[scope]);
+		}
+	}
+	// clones get their own summaries, a specialized body may also have lost its global accesses
+	sideEffects = SideEffects(_symbolTable, _atoms);
+	// unrolling only grows the code at -O2, under -Os a loop is unrolled only if it gets smaller
+	LoopUnrolling loopUnrolling(_symbolTable, _translator, parameters.optimizeForSize ? 0 : 64);
+	for (auto& pair : _atoms) {
+		bool changed = RedundantCalls(_symbolTable, sideEffects).run(pair.second);
+		LoopInvariantCodeMotion(_symbolTable, sideEffects, _hoistedAtoms[pair.first]).run(pair.second);
+		changed = InductionVariables(_symbolTable, pair.first).run(pair.second) || changed;
+		if (parameters.optimizationLevel >= 2) {
+			changed = loopUnrolling.run(pair.second) || changed;
+		}
+		if (changed) {
+			constantPropagation.run(pair.second, interproceduralConstants.parameters(pair.first));
+			jumpThreading.run(pair.second);
+		}
+	}
+	// the remaining tail calls are kept as CALLs until now so that they can be inlined
+	for (auto& pair : _atoms) {
+		tailCalls.reuseFrames(pair.first, pair.second);
+	}
+	// last, as every pass above may allocate temps or change live ranges
+	StackSlots stackSlots(_symbolTable);
+	for (const auto& pair : _atoms) {
+		stackSlots.run(pair.first, pair.second);
+	}
+}
+
+const std::map<Scope, std::map<int, size_t>>& Optimizer::hoistedAtoms() const {
+	return _hoistedAtoms;
+}
@@ -0,0 +1,182 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <sstream>
+#include "../include/Peephole.h"
+
+bool Peephole::Instruction::is(const std::string& mnemonic, const std::vector<std::string>& operands) const {
+	// labeled instructions are jump targets and never take part in a rewrite
+	return label.empty() && this->mnemonic == mnemonic && (operands.empty() || this->operands == operands);
+}
+
+static bool isLabel(const Peephole::Instruction& instruction, const std::string& label) {
+	return instruction.label == label && instruction.mnemonic.empty();
+}
+
+static const std::map<std::string, std::string> inverseJumps = {
+		{"JZ", "JNZ"}, {"JNZ", "JZ"}, {"JC", "JNC"}, {"JNC", "JC"},
+		{"JP", "JM"}, {"JM", "JP"}, {"JPE", "JPO"}, {"JPO", "JPE"}
+};
+
+const std::vector<Peephole::Rule>& Peephole::rules() {
+	static const std::vector<Rule> rules = {
+			{"store-load", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("STA") && w[1].is("LDA", w[0].operands);
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, ""};
+					}},
+			{"load-store", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("LDA") && w[1].is("STA", w[0].operands);
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, ""};
+					}},
+			{"stack-store-load", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("MOV", {"M", "A"}) && w[1].is("MOV", {"A", "M"});
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, ""};
+					}},
+			{"stack-load-store", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("MOV", {"A", "M"}) && w[1].is("MOV", {"M", "A"});
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, ""};
+					}},
+			{"repeated-move", 2,
+					[](const std::vector<Instruction>& w) {
+						return (w[0].is("MOV") || w[0].is("LDA")) && w[1].is(w[0].mnemonic, w[0].operands) &&
+						       (w[0].operands.size() != 2 || w[0].operands[0] != w[0].operands[1]);
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, ""};
+					}},
+			// HL still points to the same slot, a MOV between A and M changes neither HL nor SP
+			{"same-address", 5,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("LXI") && w[0].operands.size() == 2 && w[0].operands[0] == "H" &&
+						       w[1].is("DAD", {"SP"}) &&
+						       (w[2].is("MOV", {"M", "A"}) || w[2].is("MOV", {"A", "M"})) &&
+						       w[3].is("LXI", w[0].operands) && w[4].is("DAD", {"SP"});
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, w[1].text, w[2].text, "", ""};
+					}},
+			{"register-round-trip", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("MOV") && w[0].operands.size() == 2 && w[0].operands[0] != "M" &&
+						       w[0].operands[1] != "M" &&
+						       w[1].is("MOV", {w[0].operands[1], w[0].operands[0]});
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{w[0].text, ""};
+					}},
+			{"push-pop", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("PUSH") && w[1].is("POP", w[0].operands);
+					},
+					[](const std::vector<Instruction>&) {
+						return std::vector<std::string>{"", ""};
+					}},
+			{"jump-to-next", 2,
+					[](const std::vector<Instruction>& w) {
+						return w[0].is("JMP") && w[0].operands.size() == 1 && isLabel(w[1], w[0].operands[0]);
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{"", w[1].text};
+					}},
+			{"branch-over-jump", 3,
+					[](const std::vector<Instruction>& w) {
+						return inverseJumps.count(w[0].mnemonic) && w[0].is(w[0].mnemonic) &&
+						       w[1].is("JMP") && isLabel(w[2], w[0].operands[0]);
+					},
+					[](const std::vector<Instruction>& w) {
+						return std::vector<std::string>{inverseJumps.at(w[0].mnemonic) + " " + w[1].operands[0], "",
+						                                w[2].text};
+					}}
+	};
+	return rules;
+}
+
+Peephole::Peephole() : _hits(rules().size(), 0) {}
+
+Peephole::Instruction Peephole::parse(const std::string& line) {
+	Instruction instruction;
+	instruction.text = line;
+	std::string text = line.substr(0, line.find(';'));
+	auto colon = text.find(':');
+	if (colon != std::string::npos) {
+		instruction.label = text.substr(0, colon);
+		text = text.substr(colon + 1);
+	}
+	std::istringstream iss(text);
+	iss >> instruction.mnemonic;
+	std::string operand;
+	while (std::getline(iss >> std::ws, operand, ',')) {
+		while (!operand.empty() && isspace(operand.back())) operand.pop_back();
+		instruction.operands.push_back(operand);
+	}
+	return instruction;
+}
+
+std::string Peephole::run(const std::string& code) {
+	std::vector<std::string> lines;
+	std::istringstream iss(code);
+	for (std::string line; std::getline(iss, line);) lines.push_back(line);
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		// indices of the lines with a label or an instruction
+		std::vector<size_t> code;
+		std::vector<Instruction> instructions;
+		for (size_t i = 0; i < lines.size(); i++) {
+			auto instruction = parse(lines[i]);
+			if (instruction.label.empty() && instruction.mnemonic.empty()) continue;
+			code.push_back(i);
+			instructions.push_back(instruction);
+		}
+		std::vector<bool> removed(lines.size(), false);
+		for (size_t position = 0; position < code.size(); position++) {
+			// the rewritten lines are parsed again on the next pass, so windows do not overlap
+			for (size_t r = 0; r < rules().size(); r++) {
+				const auto& rule = rules()[r];
+				if (position + rule.window > code.size()) continue;
+				std::vector<Instruction> window(instructions.begin() + position,
+				                                instructions.begin() + position + rule.window);
+				if (!rule.matches(window)) continue;
+				auto rewritten = rule.rewrite(window);
+				for (size_t k = 0; k < rule.window; k++) {
+					if (rewritten[k].empty()) removed[code[position + k]] = true;
+					else lines[code[position + k]] = rewritten[k];
+				}
+				_hits[r]++;
+				changed = true;
+				position += rule.window - 1;
+				break;
+			}
+		}
+		std::vector<std::string> kept;
+		for (size_t i = 0; i < lines.size(); i++) {
+			if (!removed[i]) kept.push_back(lines[i]);
+		}
+		lines = kept;
+	}
+	std::string out;
+	for (const auto& line : lines) out += line + "\n";
+	return out;
+}
+
+std::vector<std::pair<std::string, size_t>> Peephole::hits() const {
+	std::vector<std::pair<std::string, size_t>> out;
+	for (size_t r = 0; r < rules().size(); r++) out.emplace_back(rules()[r].name, _hits[r]);
+	return out;
+}
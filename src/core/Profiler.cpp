@@ -0,0 +1,184 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <sstream>
+#include "../include/Assembly.h"
+#include "../include/Emulator.h"
+#include "../include/Profiler.h"
+
+Profiler::Profiler(std::vector<Translator::ListingLine> listing) : _listing(std::move(listing)) {}
+
+void Profiler::run(std::istream& input, std::ostream& output, size_t limit) {
+	std::string code;
+	for (const auto& line : _listing) code += line.text + "\n";
+	Emulator emulator(code);
+	// the first instruction of an atom counts its hits, CALL and RET move along the call stack
+	std::vector<bool> first(_listing.size(), false);
+	std::vector<bool> calls(_listing.size(), false);
+	std::vector<bool> returns(_listing.size(), false);
+	std::pair<Scope, int> last = {GLOBAL_SCOPE, -1};
+	for (size_t i = 0; i < _listing.size(); i++) {
+		auto instruction = Assembly::parse(_listing[i].text);
+		if (instruction.mnemonic.empty()) continue;
+		std::pair<Scope, int> owner = {_listing[i].scope, _listing[i].atom};
+		first[i] = owner.second >= 0 && owner != last;
+		last = owner;
+		calls[i] = instruction.mnemonic == "CALL" && !instruction.operands.empty() &&
+		           instruction.operands[0][0] != '@';
+		returns[i] = instruction.mnemonic == "RET" && !_listing[i].function.empty();
+	}
+	std::vector<std::string> stack;
+	std::vector<std::string> folded;
+	// a recursive function and a repeated edge are counted once in the inclusive cycles
+	std::map<std::string, size_t> onStack;
+	std::map<std::pair<std::string, std::string>, size_t> edgesOnStack;
+	auto push = [&](const std::string& function) {
+		_calls[function]++;
+		onStack[function]++;
+		if (!stack.empty()) {
+			_edges[{stack.back(), function}].calls++;
+			edgesOnStack[{stack.back(), function}]++;
+		}
+		folded.push_back(folded.empty() ? function : folded.back() + ";" + function);
+		stack.push_back(function);
+	};
+	auto pop = [&]() {
+		if (--onStack[stack.back()] == 0) onStack.erase(stack.back());
+		if (stack.size() > 1) {
+			auto edge = edgesOnStack.find({stack[stack.size() - 2], stack.back()});
+			if (--edge->second == 0) edgesOnStack.erase(edge);
+		}
+		stack.pop_back();
+		folded.pop_back();
+	};
+	bool pendingCall = false;
+	bool pendingReturn = false;
+	emulator.run(input, output, [&](size_t index, size_t cycles) {
+		const auto& line = _listing[index];
+		if (pendingReturn && !stack.empty()) pop();
+		if (!line.function.empty()) {
+			if (pendingCall || stack.empty()) {
+				push(line.function);
+			} else if (stack.back() != line.function) {
+				// a tail call takes over the frame of its caller
+				pop();
+				push(line.function);
+			}
+		}
+		pendingCall = calls[index];
+		pendingReturn = returns[index];
+		_cycles += cycles;
+		// the vectors and the counter dump run on behalf of the function on top
+		if (stack.empty()) return;
+		_selfCycles[stack.back()] += cycles;
+		if (line.row != 0) _lineCycles[{line.function, line.row}] += cycles;
+		if (first[index]) _atomHits[{line.function, line.atom}]++;
+		_stacks[folded.back()] += cycles;
+		for (const auto& function : onStack) _totalCycles[function.first] += cycles;
+		for (const auto& edge : edgesOnStack) _edges[edge.first].cycles += cycles;
+	}, limit);
+	_counterDump = emulator.portOutput(2);
+}
+
+const std::string& Profiler::counterDump() const {
+	return _counterDump;
+}
+
+size_t Profiler::cycles() const {
+	return _cycles;
+}
+
+const std::map<std::pair<std::string, int>, size_t>& Profiler::atomHits() const {
+	return _atomHits;
+}
+
+std::map<std::pair<std::string, int>, size_t> Profiler::readAtomHits(std::istream& stream) {
+	std::map<std::pair<std::string, int>, size_t> out;
+	bool hits = false;
+	for (std::string line; std::getline(stream, line);) {
+		if (!hits) {
+			hits = line == "ATOM HITS:";
+			continue;
+		}
+		// "function atom: hits (atom)"
+		std::istringstream iss(line);
+		std::string function;
+		int atom;
+		char colon;
+		size_t count;
+		if (!(iss >> function >> atom >> colon >> count) || colon != ':') break;
+		out[{function, atom}] += count;
+	}
+	return out;
+}
+
+bool Profiler::printCounterProfile(std::ostream& stream, const std::vector<Translator::ProfileCounter>& counters,
+                                   std::istream& dump) {
+	// every counter is a little-endian word, a block counter gives the hits of the first atom of its block
+	std::map<std::pair<std::string, int>, size_t> hits;
+	std::map<std::pair<std::string, std::string>, size_t> calls;
+	for (const auto& counter : counters) {
+		int low = dump.get();
+		int high = dump.get();
+		if (high == EOF) return false;
+		size_t count = static_cast<size_t>(high << 8 | low);
+		if (counter.callee.empty()) {
+			hits[{counter.function, counter.atom}] += count;
+		} else {
+			calls[{counter.function, counter.callee}] += count;
+		}
+	}
+	stream << "CALL GRAPH:" << std::endl;
+	for (const auto& edge : calls) {
+		stream << edge.first.first << " -> " << edge.first.second << ": " << edge.second << " calls" << std::endl;
+	}
+	stream << std::endl << "ATOM HITS:" << std::endl;
+	for (const auto& atom : hits) {
+		if (atom.second > 0) stream << atom.first.first << " " << atom.first.second << ": " << atom.second << std::endl;
+	}
+	return true;
+}
+
+void Profiler::printProfile(std::ostream& stream) const {
+	stream << "FLAT PROFILE:" << std::endl;
+	for (size_t i = 0; i < 64; i++) stream << "-";
+	stream << std::endl;
+	stream << "total: " << _cycles << " cycles" << std::endl;
+	std::vector<std::pair<std::string, size_t>> functions(_selfCycles.begin(), _selfCycles.end());
+	std::stable_sort(functions.begin(), functions.end(), [](const auto& a, const auto& b) {
+		return a.second > b.second;
+	});
+	for (const auto& function : functions) {
+		stream << "function " << function.first << ": " << function.second << " self cycles, "
+		       << _totalCycles.at(function.first) << " total cycles, " << _calls.at(function.first) << " calls"
+		       << std::endl;
+	}
+	stream << std::endl << "LINE PROFILE:" << std::endl;
+	std::vector<std::pair<std::pair<std::string, size_t>, size_t>> lines(_lineCycles.begin(), _lineCycles.end());
+	std::stable_sort(lines.begin(), lines.end(), [](const auto& a, const auto& b) {
+		return a.second > b.second;
+	});
+	for (const auto& line : lines) {
+		stream << line.first.first << " line " << line.first.second << ": " << line.second << " cycles" << std::endl;
+	}
+	stream << std::endl << "CALL GRAPH:" << std::endl;
+	for (const auto& edge : _edges) {
+		stream << edge.first.first << " -> " << edge.first.second << ": " << edge.second.calls << " calls, "
+		       << edge.second.cycles << " cycles" << std::endl;
+	}
+	stream << std::endl << "ATOM HITS:" << std::endl;
+	std::pair<Scope, int> last = {GLOBAL_SCOPE, -1};
+	for (const auto& line : _listing) {
+		if (line.atom < 0 || std::make_pair(line.scope, line.atom) == last) continue;
+		last = {line.scope, line.atom};
+		auto hits = _atomHits.find({line.function, line.atom});
+		if (hits == _atomHits.end()) continue;
+		stream << line.function << " " << line.atom << ": " << hits->second << " " << line.atomText << std::endl;
+	}
+}
+
+void Profiler::printFoldedStacks(std::ostream& stream) const {
+	for (const auto& stack : _stacks) stream << stack.first << " " << stack.second << std::endl;
+}
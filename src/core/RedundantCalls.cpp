@@ -0,0 +1,100 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <functional>
+#include "../include/RedundantCalls.h"
+
+struct AvailableCall {
+	size_t function;
+	std::vector<std::shared_ptr<RValue>> arguments;
+	std::shared_ptr<MemoryOperand> result;
+	bool readsGlobals;
+
+	bool mentions(size_t index) const {
+		if (result->index() == index) return true;
+		for (const auto& argument : arguments) {
+			auto memory = std::dynamic_pointer_cast<MemoryOperand>(argument);
+			if (memory && memory->index() == index) return true;
+		}
+		return false;
+	}
+};
+
+static bool sameOperand(const std::shared_ptr<RValue>& a, const std::shared_ptr<RValue>& b) {
+	auto numberA = std::dynamic_pointer_cast<NumberOperand>(a);
+	auto numberB = std::dynamic_pointer_cast<NumberOperand>(b);
+	if (numberA || numberB) return numberA && numberB && numberA->value() == numberB->value();
+	auto memoryA = std::dynamic_pointer_cast<MemoryOperand>(a);
+	auto memoryB = std::dynamic_pointer_cast<MemoryOperand>(b);
+	return memoryA && memoryB && memoryA->index() == memoryB->index();
+}
+
+RedundantCalls::RedundantCalls(const SymbolTable& symbolTable, const SideEffects& sideEffects)
+		: _symbolTable(symbolTable), _sideEffects(sideEffects) {}
+
+bool RedundantCalls::run(std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// a call of a function without side effects repeated with the same arguments, and with no
+	// label in between, is a copy of the first result. Globals are only read by the callee, so
+	// a store to any global or a call that may write one ends the reuse.
+	bool changed = false;
+	std::vector<AvailableCall> available;
+	std::vector<std::shared_ptr<Atom>> out;
+	auto kill = [&available](const std::function<bool(const AvailableCall&)>& killed) {
+		available.erase(std::remove_if(available.begin(), available.end(), killed), available.end());
+	};
+	for (const auto& atom : atoms) {
+		if (std::dynamic_pointer_cast<LabelAtom>(atom)) available.clear();
+		auto call = std::dynamic_pointer_cast<CallAtom>(atom);
+		if (call) {
+			const auto& effects = _sideEffects.of(atom);
+			size_t function = call->function()->index();
+			int n = _symbolTable._records[function]._len;
+			// PARAMs were moved right before their CALL
+			bool hasArguments = int(out.size()) >= n;
+			for (int i = 1; hasArguments && i <= n; i++) {
+				hasArguments = bool(std::dynamic_pointer_cast<ParamAtom>(out[out.size() - i]));
+			}
+			if (effects.writesGlobals) kill([](const AvailableCall& entry) { return entry.readsGlobals; });
+			if (effects.isReadOnly() && hasArguments) {
+				std::vector<std::shared_ptr<RValue>> arguments;
+				for (auto it = out.end() - n; it != out.end(); ++it) {
+					arguments.push_back(std::dynamic_pointer_cast<ParamAtom>(*it)->value());
+				}
+				auto same = std::find_if(available.begin(), available.end(), [&](const AvailableCall& entry) {
+					return entry.function == function &&
+					       std::equal(arguments.begin(), arguments.end(), entry.arguments.begin(), sameOperand);
+				});
+				size_t result = call->result()->index();
+				if (same != available.end()) {
+					auto copy = std::make_shared<UnaryOpAtom>("MOV", same->result, call->result());
+					out.erase(out.end() - n, out.end());
+					out.push_back(copy);
+					kill([result](const AvailableCall& entry) { return entry.mentions(result); });
+					changed = true;
+					continue;
+				}
+				kill([result](const AvailableCall& entry) { return entry.mentions(result); });
+				AvailableCall entry = {function, arguments, call->result(), !effects.isPure()};
+				if (!std::any_of(arguments.begin(), arguments.end(), [&](const std::shared_ptr<RValue>& argument) {
+					return sameOperand(argument, call->result());
+				})) {
+					available.push_back(entry);
+				}
+				out.push_back(atom);
+				continue;
+			}
+		}
+		if (auto def = atom->def()) {
+			size_t index = def->index();
+			kill([index](const AvailableCall& entry) { return entry.mentions(index); });
+			if (_symbolTable._records[index]._scope == GLOBAL_SCOPE) {
+				kill([](const AvailableCall& entry) { return entry.readsGlobals; });
+			}
+		}
+		out.push_back(atom);
+	}
+	if (changed) atoms = out;
+	return changed;
+}
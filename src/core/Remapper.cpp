@@ -0,0 +1,79 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/Remapper.h"
+
+std::shared_ptr<MemoryOperand> Remapper::rename(const std::shared_ptr<MemoryOperand>& memory,
+                                                const Variables& variables) {
+	auto it = variables.find(memory->index());
+	return it == variables.end() ? memory : it->second;
+}
+
+std::shared_ptr<RValue> Remapper::rename(const std::shared_ptr<RValue>& operand, const Variables& variables) {
+	auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+	return memory ? rename(memory, variables) : operand;
+}
+
+std::shared_ptr<LabelOperand> Remapper::rename(const std::shared_ptr<LabelOperand>& label, const Labels& labels) {
+	auto it = labels.find(label->labelId());
+	return it == labels.end() ? label : it->second;
+}
+
+std::shared_ptr<Atom> Remapper::remap(const std::shared_ptr<Atom>& atom, const Variables& variables,
+                                      const Labels& labels) {
+	auto out = copy(atom, variables, labels);
+	if (out != atom) out->setLine(atom->line());
+	return out;
+}
+
+std::shared_ptr<Atom> Remapper::copy(const std::shared_ptr<Atom>& atom, const Variables& variables,
+                                     const Labels& labels) {
+	if (auto binary = std::dynamic_pointer_cast<BinaryOpAtom>(atom)) {
+		return std::make_shared<BinaryOpAtom>(binary->name(), rename(binary->left(), variables),
+		                                      rename(binary->right(), variables),
+		                                      rename(binary->result(), variables));
+	}
+	if (auto unary = std::dynamic_pointer_cast<UnaryOpAtom>(atom)) {
+		return std::make_shared<UnaryOpAtom>(unary->name(), rename(unary->operand(), variables),
+		                                     rename(unary->result(), variables));
+	}
+	if (auto out = std::dynamic_pointer_cast<OutAtom>(atom)) {
+		auto value = std::dynamic_pointer_cast<RValue>(out->value());
+		return value ? std::make_shared<OutAtom>(rename(value, variables)) : atom;
+	}
+	if (auto in = std::dynamic_pointer_cast<InAtom>(atom)) {
+		return std::make_shared<InAtom>(rename(in->result(), variables));
+	}
+	if (auto label = std::dynamic_pointer_cast<LabelAtom>(atom)) {
+		return std::make_shared<LabelAtom>(rename(label->label(), labels));
+	}
+	if (auto jump = std::dynamic_pointer_cast<JumpAtom>(atom)) {
+		return std::make_shared<JumpAtom>(rename(jump->label(), labels));
+	}
+	if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom)) {
+		return std::make_shared<ConditionalJumpAtom>(conditionalJump->condition(),
+		                                             rename(conditionalJump->left(), variables),
+		                                             rename(conditionalJump->right(), variables),
+		                                             rename(conditionalJump->label(), labels));
+	}
+	if (auto switchAtom = std::dynamic_pointer_cast<SwitchAtom>(atom)) {
+		SwitchAtom::Cases cases;
+		for (const auto& pair : switchAtom->cases()) cases.emplace_back(pair.first, rename(pair.second, labels));
+		return std::make_shared<SwitchAtom>(rename(switchAtom->value(), variables), cases,
+		                                    rename(switchAtom->defaultLabel(), labels));
+	}
+	if (auto call = std::dynamic_pointer_cast<CallAtom>(atom)) {
+		return std::make_shared<CallAtom>(call->function(), rename(call->result(), variables));
+	}
+	if (auto param = std::dynamic_pointer_cast<ParamAtom>(atom)) {
+		return std::make_shared<ParamAtom>(rename(param->value(), variables));
+	}
+	if (auto ret = std::dynamic_pointer_cast<RetAtom>(atom)) {
+		return std::make_shared<RetAtom>(rename(ret->value(), variables));
+	}
+	if (auto tailCall = std::dynamic_pointer_cast<TailCallAtom>(atom)) {
+		return std::make_shared<TailCallAtom>(tailCall->function());
+	}
+	return atom;
+}
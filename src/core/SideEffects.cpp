@@ -0,0 +1,72 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/SideEffects.h"
+#include "../include/CallGraph.h"
+
+bool SideEffects::Summary::isPure() const {
+	return !readsGlobals && !writesGlobals && !io;
+}
+
+bool SideEffects::Summary::isReadOnly() const {
+	return !writesGlobals && !io;
+}
+
+bool SideEffects::Summary::operator==(const Summary& rhs) const {
+	return readsGlobals == rhs.readsGlobals && writesGlobals == rhs.writesGlobals && io == rhs.io;
+}
+
+bool SideEffects::Summary::operator!=(const Summary& rhs) const {
+	return !(rhs == *this);
+}
+
+SideEffects::SideEffects(const SymbolTable& symbolTable,
+                         const std::map<Scope, std::vector<std::shared_ptr<Atom>>>& program) {
+	auto isGlobal = [&symbolTable](const std::shared_ptr<RValue>& operand) {
+		auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+		return memory && symbolTable._records[memory->index()]._scope == GLOBAL_SCOPE;
+	};
+	for (const auto& pair : program) {
+		Summary summary;
+		summary.readsGlobals = summary.writesGlobals = summary.io = false;
+		for (const auto& atom : pair.second) {
+			for (const auto& use : atom->uses()) {
+				if (isGlobal(use)) summary.readsGlobals = true;
+			}
+			if (isGlobal(atom->def())) summary.writesGlobals = true;
+			if (std::dynamic_pointer_cast<InAtom>(atom) || std::dynamic_pointer_cast<OutAtom>(atom)) summary.io = true;
+		}
+		_summaries[pair.first] = summary;
+	}
+	// a function has the effects of everything it calls, a function without atoms has all of them
+	CallGraph graph(program);
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (auto& pair : _summaries) {
+			Summary summary = pair.second;
+			for (Scope callee : graph.callees(pair.first)) {
+				const auto& effects = (*this)[callee];
+				summary.readsGlobals = summary.readsGlobals || effects.readsGlobals;
+				summary.writesGlobals = summary.writesGlobals || effects.writesGlobals;
+				summary.io = summary.io || effects.io;
+			}
+			if (summary != pair.second) {
+				pair.second = summary;
+				changed = true;
+			}
+		}
+	}
+}
+
+const SideEffects::Summary& SideEffects::operator[](Scope function) const {
+	auto it = _summaries.find(function);
+	return it == _summaries.end() ? _unknown : it->second;
+}
+
+const SideEffects::Summary& SideEffects::of(const std::shared_ptr<Atom>& call) const {
+	if (auto callAtom = std::dynamic_pointer_cast<CallAtom>(call)) return (*this)[callAtom->function()->index()];
+	if (auto tailCall = std::dynamic_pointer_cast<TailCallAtom>(call)) return (*this)[tailCall->function()->index()];
+	return _unknown;
+}
@@ -0,0 +1,80 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <map>
+#include "../include/StackSlots.h"
+#include "../include/ControlFlowGraph.h"
+#include "../include/Liveness.h"
+
+StackSlots::StackSlots(SymbolTable& symbolTable) : _symbolTable(symbolTable) {}
+
+size_t StackSlots::run(Scope scope, const std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// parameters keep the slots the caller pushed, everything else of the scope is colored
+	std::vector<size_t> locals;
+	int parameters = _symbolTable._records[scope]._len;
+	for (size_t i = 0; i < _symbolTable._records.size(); i++) {
+		const auto& record = _symbolTable._records[i];
+		if (record._scope != scope || record._kind != SymbolTable::TableRecord::RecordKind::var) continue;
+		if (parameters-- > 0) continue;
+		locals.push_back(i);
+	}
+	std::map<size_t, size_t> local;
+	for (size_t i = 0; i < locals.size(); i++) local[locals[i]] = i;
+	std::vector<std::vector<bool>> interferes(locals.size(), std::vector<bool>(locals.size(), false));
+	std::vector<bool> mentioned(locals.size(), false);
+	auto link = [&](size_t a, size_t b) {
+		if (a == b) return;
+		interferes[a][b] = interferes[b][a] = true;
+	};
+
+	ControlFlowGraph graph(atoms);
+	Liveness liveness(_symbolTable, graph);
+	if (graph.size() > 0) {
+		// locals read before any write rely on the zeroed frame, so they all hold their slots at entry
+		for (size_t a : locals) {
+			for (size_t b : locals) {
+				if (liveness.liveIn(0).test(a) && liveness.liveIn(0).test(b)) link(local[a], local[b]);
+			}
+		}
+	}
+	for (size_t block = 0; block < graph.size(); block++) {
+		const auto& blockAtoms = graph[block].atoms;
+		for (size_t i = 0; i < blockAtoms.size(); i++) {
+			for (const auto& use : blockAtoms[i]->uses()) {
+				auto memory = std::dynamic_pointer_cast<MemoryOperand>(use);
+				if (memory && local.count(memory->index())) mentioned[local[memory->index()]] = true;
+			}
+			auto def = blockAtoms[i]->def();
+			if (!def || !local.count(def->index())) continue;
+			size_t defined = local[def->index()];
+			mentioned[defined] = true;
+			// the destination of a copy may share the slot of its source
+			std::shared_ptr<MemoryOperand> source;
+			auto unary = std::dynamic_pointer_cast<UnaryOpAtom>(blockAtoms[i]);
+			if (unary && unary->name() == "MOV") source = std::dynamic_pointer_cast<MemoryOperand>(unary->operand());
+			const auto& live = liveness.liveOut(block, i);
+			for (size_t other : locals) {
+				if (!live.test(other) || (source && source->index() == other)) continue;
+				link(defined, local[other]);
+			}
+		}
+	}
+
+	size_t slots = 0;
+	std::vector<int> colors(locals.size(), -1);
+	for (size_t i = 0; i < locals.size(); i++) {
+		if (!mentioned[i]) continue;
+		std::vector<bool> taken(slots, false);
+		for (size_t j = 0; j < locals.size(); j++) {
+			if (interferes[i][j] && colors[j] >= 0) taken[colors[j]] = true;
+		}
+		size_t color = 0;
+		while (color < slots && taken[color]) color++;
+		if (color == slots) slots++;
+		colors[i] = int(color);
+	}
+	for (size_t i = 0; i < locals.size(); i++) _symbolTable._records[locals[i]]._slot = colors[i];
+	_symbolTable.setFrameSlots(scope, slots);
+	return slots;
+}
@@ -33,8 +33,13 @@ void StringTable::printStringTable(std::ostream& stream) {
 	}
 }
 
-void StringTable::generateStrings(std::ostream &stream) const {
+size_t StringTable::size() const {
+	return _strings.size();
+}
+
+void StringTable::generateStrings(std::ostream &stream, const std::vector<bool>& live) const {
     for(size_t i = 0; i < _strings.size(); i++) {
+        if (!live.empty() && !live[i]) continue;
         stream << "str" + std::to_string(i) + ": DB \'" + _strings[i] + "\', 0\n";
     }
 }
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <vector>
 #include "../include/SymbolTable.h"
+#include "../include/GlobalParameters.h"
 
 bool SymbolTable::TableRecord::operator==(const SymbolTable::TableRecord& rhs) const {
 	return (_name == rhs._name &&
@@ -33,6 +34,11 @@ size_t SymbolTable::size() const {
 }
 
 size_t SymbolTable::getM(Scope scope) const {
+	auto it = _frameSlots.find(scope);
+	return it == _frameSlots.end() ? getLocalCount(scope) : it->second;
+}
+
+size_t SymbolTable::getLocalCount(Scope scope) const {
     if (scope < 0 || scope >= _records.size()) return 0;
     int64_t variableAmount = 0;
     for (const auto & _record : _records) {
@@ -41,19 +47,38 @@ size_t SymbolTable::getM(Scope scope) const {
     return size_t(variableAmount - _records[scope]._len);
 }
 
+size_t SymbolTable::getFrameSize(Scope scope) const {
+	return getSlotSize() * getM(scope);
+}
+
+size_t SymbolTable::getSlotSize() {
+	return GlobalParameters::getInstance().byteFrames ? 1 : 2;
+}
+
+void SymbolTable::setFrameSlots(Scope scope, size_t count) {
+	_frameSlots[scope] = count;
+}
+
+bool SymbolTable::hasColoredFrame(Scope scope) const {
+	return _frameSlots.count(scope) != 0;
+}
+
 void SymbolTable::calculateOffset() {
-    int n, m, i;
+    // parameters are pushed by the caller as words above the return address, locals lie below it
+    int n, frame, slot, i;
     TableRecord rec;
     for (auto& _record : _records) {
         rec = _record;
         if (rec._kind == TableRecord::RecordKind::func || rec._scope == -1) continue;
         n = _records[rec._scope]._len;
-        m = getM(rec._scope);
+        frame = getFrameSize(rec._scope);
+        slot = getSlotSize();
         i = 1;
         for (auto& record : _records) {
             if (record._kind == TableRecord::RecordKind::var && record._scope == rec._scope) {
-                if (i <= n) record._offset = 2 * (m + n + 1 - i);
-                else record._offset = 2 * (m + n - i);
+                if (i <= n) record._offset = frame + 2 * (n + 1 - i);
+                else if (!hasColoredFrame(rec._scope)) record._offset = frame - slot * (i - n);
+                else record._offset = record._slot < 0 ? -1 : frame - slot * (record._slot + 1);
                 i++;
             }
         }
@@ -227,8 +252,9 @@ void SymbolTable::changeFuncLength(const std::string& name, int newLen) {
 	}
 }
 
-void SymbolTable::generateGlobals(std::ostream &stream) const {
+void SymbolTable::generateGlobals(std::ostream &stream, const std::vector<bool>& live) const {
     for(size_t i = 0; i < _records.size(); i++) {
+        if (!live.empty() && !live[i]) continue;
         if(_records[i]._scope == -1 && _records[i]._kind != SymbolTable::TableRecord::RecordKind::func) {
             stream << "var" + std::to_string(i) + ": DB " + std::to_string(_records[i]._init) + "\n";
         }
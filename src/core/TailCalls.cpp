@@ -0,0 +1,113 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include "../include/GlobalParameters.h"
+#include "../include/TailCalls.h"
+#include "../include/Translator.h"
+
+TailCalls::TailCalls(SymbolTable& symbolTable, Translator& translator)
+		: _symbolTable(symbolTable), _translator(translator) {}
+
+bool TailCalls::isReturned(const std::vector<std::shared_ptr<Atom>>& atoms, size_t call) {
+	// (CALL, f,, t) followed, maybe through labels, by (RET,,, t)
+	auto result = std::dynamic_pointer_cast<CallAtom>(atoms[call])->result();
+	for (size_t i = call + 1; i < atoms.size(); i++) {
+		if (std::dynamic_pointer_cast<LabelAtom>(atoms[i])) continue;
+		auto ret = std::dynamic_pointer_cast<RetAtom>(atoms[i]);
+		auto value = ret ? std::dynamic_pointer_cast<MemoryOperand>(ret->value()) : nullptr;
+		return value && value->index() == result->index();
+	}
+	return false;
+}
+
+bool TailCalls::hasArguments(const std::vector<std::shared_ptr<Atom>>& atoms, int n) {
+	// PARAMs were moved right before their CALL, so the arguments are the last n atoms
+	if (int(atoms.size()) < n) return false;
+	for (int i = 1; i <= n; i++) {
+		if (!std::dynamic_pointer_cast<ParamAtom>(atoms[atoms.size() - i])) return false;
+	}
+	return true;
+}
+
+bool TailCalls::eliminateRecursion(Scope scope, std::vector<std::shared_ptr<Atom>>& atoms) {
+	// a self-recursive tail call assigns the arguments to the parameters and jumps to the entry
+	int n = _symbolTable._records[scope]._len;
+	std::vector<std::shared_ptr<MemoryOperand>> parameters;
+	std::vector<std::shared_ptr<MemoryOperand>> locals;
+	for (size_t i = 0, size = _symbolTable.size(); i < size; i++) {
+		const auto& record = _symbolTable._records[i];
+		if (record._scope != scope || record._kind != SymbolTable::TableRecord::RecordKind::var) continue;
+		auto variable = std::make_shared<MemoryOperand>(i, &_symbolTable);
+		if (int(parameters.size()) < n) {
+			parameters.push_back(variable);
+		} else if (record._name[0] != '!') {
+			locals.push_back(variable);
+		}
+	}
+	std::shared_ptr<LabelOperand> entry;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t i = 0; i < atoms.size(); i++) {
+		auto call = std::dynamic_pointer_cast<CallAtom>(atoms[i]);
+		if (!call || static_cast<Scope>(call->function()->index()) != scope || !isReturned(atoms, i) ||
+		    !hasArguments(out, n)) {
+			out.push_back(atoms[i]);
+			continue;
+		}
+		if (!entry) entry = _translator.newLabel();
+		std::vector<std::shared_ptr<RValue>> values;
+		for (auto it = out.end() - n; it != out.end(); ++it) {
+			values.push_back(std::dynamic_pointer_cast<ParamAtom>(*it)->value());
+		}
+		out.erase(out.end() - n, out.end());
+		// an argument reading a parameter that is assigned before it is saved to a temp first
+		for (int j = 0; j < n; j++) {
+			auto memory = std::dynamic_pointer_cast<MemoryOperand>(values[j]);
+			for (int k = 0; memory && k < j; k++) {
+				if (parameters[k]->index() == memory->index()) {
+					auto temp = _symbolTable.alloc(scope);
+					out.push_back(std::make_shared<UnaryOpAtom>("MOV", values[j], temp));
+					values[j] = temp;
+					break;
+				}
+			}
+		}
+		for (int j = 0; j < n; j++) {
+			auto memory = std::dynamic_pointer_cast<MemoryOperand>(values[j]);
+			if (memory && memory->index() == parameters[j]->index()) continue;
+			out.push_back(std::make_shared<UnaryOpAtom>("MOV", values[j], parameters[j]));
+		}
+		// the locals of a new activation start zeroed
+		for (const auto& local : locals) {
+			out.push_back(std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(0), local));
+		}
+		out.push_back(std::make_shared<JumpAtom>(entry));
+		if (i + 1 < atoms.size() && std::dynamic_pointer_cast<RetAtom>(atoms[i + 1])) i++;
+	}
+	if (!entry) return false;
+	out.insert(out.begin(), std::make_shared<LabelAtom>(entry));
+	atoms = out;
+	return true;
+}
+
+bool TailCalls::reuseFrames(Scope scope, std::vector<std::shared_ptr<Atom>>& atoms) const {
+	// a tail call to a function with as many parameters can hand over the frame, but an
+	// instrumented main has to get control back to write its counters
+	if (GlobalParameters::getInstance().profileGenerate && _symbolTable._records[scope]._name == "main") return false;
+	int n = _symbolTable._records[scope]._len;
+	bool changed = false;
+	std::vector<std::shared_ptr<Atom>> out;
+	for (size_t i = 0; i < atoms.size(); i++) {
+		auto call = std::dynamic_pointer_cast<CallAtom>(atoms[i]);
+		if (!call || _symbolTable._records[call->function()->index()]._len != n || !isReturned(atoms, i) ||
+		    !hasArguments(out, n)) {
+			out.push_back(atoms[i]);
+			continue;
+		}
+		out.push_back(std::make_shared<TailCallAtom>(call->function()));
+		if (i + 1 < atoms.size() && std::dynamic_pointer_cast<RetAtom>(atoms[i + 1])) i++;
+		changed = true;
+	}
+	if (changed) atoms = out;
+	return changed;
+}
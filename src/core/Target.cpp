@@ -0,0 +1,515 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+#include "../include/Assembly.h"
+#include "../include/GlobalParameters.h"
+#include "../include/Target.h"
+#include "../include/Translator.h"
+
+const Target *Target::get(const std::string& name) {
+	static const Intel8080Target intel8080;
+	static const Z80Target z80;
+	if (name == intel8080.name()) return &intel8080;
+	if (name == z80.name()) return &z80;
+	return nullptr;
+}
+
+const Target& Target::current() {
+	auto target = get(GlobalParameters::getInstance().target);
+	if (!target) throw CodeGenerationException("Unknown target " + GlobalParameters::getInstance().target);
+	return *target;
+}
+
+std::string Intel8080Target::name() const {
+	return "8080";
+}
+
+void Intel8080Target::generateHelpers(std::ostream& stream) const {
+	stream << "@MULT:\n";
+	stream << "; Code for MULT library function\n";
+	stream << "@PRINT:\n";
+	stream << "; Code for PRINT library function\n";
+}
+
+std::string Intel8080Target::lowerHeader(const std::string& code) const {
+	return code;
+}
+
+std::string Intel8080Target::lowerFunction(const std::string& code) const {
+	return code;
+}
+
+size_t Intel8080Target::instructionSize(const std::string& line) const {
+	return Assembly::instructionSize(line);
+}
+
+size_t Intel8080Target::instructionCycles(const std::string& line) const {
+	return Assembly::instructionCycles(line);
+}
+
+// a line split into its label, instruction and comment
+struct AssemblyLine {
+	std::string label;
+	std::string mnemonic;
+	std::vector<std::string> operands;
+	std::string comment;
+	std::string text;
+
+	std::string operand(size_t i) const {
+		return i < operands.size() ? operands[i] : std::string();
+	}
+};
+
+static AssemblyLine split(const std::string& text) {
+	AssemblyLine line;
+	line.text = text;
+	size_t end = 0;
+	for (bool quoted = false; end < text.size() && (quoted || text[end] != ';'); end++) {
+		if (text[end] == '\'') quoted = !quoted;
+	}
+	line.comment = text.substr(end);
+	std::string code = text.substr(0, end);
+	auto colon = code.find(':');
+	if (colon != std::string::npos && code.find('\'') > colon) {
+		line.label = code.substr(0, colon);
+		code = code.substr(colon + 1);
+	}
+	std::istringstream iss(code);
+	iss >> line.mnemonic;
+	std::string operand;
+	while (std::getline(iss >> std::ws, operand, ',')) {
+		while (!operand.empty() && isspace(operand.back())) operand.pop_back();
+		line.operands.push_back(operand);
+	}
+	return line;
+}
+
+static std::string join(const AssemblyLine& line, const std::string& instruction) {
+	if (line.label.empty()) return instruction + line.comment;
+	return line.label + ": " + instruction + line.comment;
+}
+
+static const std::set<std::string> directives = {"ORG", "END", "EQU", "DB", "DW"};
+
+static const std::set<std::string> conditions = {"NZ", "Z", "NC", "C", "PO", "PE", "P", "M"};
+
+// J, C or R for a jump, a call or a return, conditional or not, empty for anything else
+static std::string branch(const std::string& mnemonic) {
+	if (mnemonic == "JMP" || mnemonic == "CALL" || mnemonic == "RET") return mnemonic.substr(0, 1);
+	if (mnemonic.size() > 1 && std::string("JCR").find(mnemonic[0]) != std::string::npos &&
+	    conditions.count(mnemonic.substr(1))) {
+		return mnemonic.substr(0, 1);
+	}
+	return "";
+}
+
+static const std::map<std::string, std::string> registerPairs = {
+		{"B", "BC"}, {"D", "DE"}, {"H", "HL"}, {"SP", "SP"}, {"PSW", "AF"}
+};
+
+static const std::map<std::string, std::string> implied = {
+		{"XCHG", "EX DE, HL"}, {"XTHL", "EX (SP), HL"}, {"SPHL", "LD SP, HL"}, {"PCHL", "JP (HL)"},
+		{"RLC", "RLCA"}, {"RRC", "RRCA"}, {"RAL", "RLA"}, {"RAR", "RRA"}, {"CMA", "CPL"}, {"CMC", "CCF"},
+		{"STC", "SCF"}, {"DAA", "DAA"}, {"RET", "RET"}, {"EI", "EI"}, {"DI", "DI"}, {"HLT", "HALT"}, {"NOP", "NOP"}
+};
+
+static const std::map<std::string, std::string> arithmetic = {
+		{"ADD", "ADD A, "}, {"ADC", "ADC A, "}, {"SUB", "SUB "}, {"SBB", "SBC A, "},
+		{"ANA", "AND "}, {"XRA", "XOR "}, {"ORA", "OR "}, {"CMP", "CP "},
+		{"ADI", "ADD A, "}, {"ACI", "ADC A, "}, {"SUI", "SUB "}, {"SBI", "SBC A, "},
+		{"ANI", "AND "}, {"XRI", "XOR "}, {"ORI", "OR "}, {"CPI", "CP "}
+};
+
+static std::string pairName(const std::string& operand) {
+	auto it = registerPairs.find(operand);
+	return it == registerPairs.end() ? operand : it->second;
+}
+
+static std::string registerName(const std::string& operand) {
+	return operand == "M" ? "(HL)" : operand;
+}
+
+// the Zilog form of an 8080 instruction, empty for a line that is kept as it is
+static std::string zilog(const AssemblyLine& line) {
+	const auto& m = line.mnemonic;
+	if (implied.count(m)) return implied.at(m);
+	if (arithmetic.count(m)) return arithmetic.at(m) + registerName(line.operand(0));
+	if (m == "MOV") return "LD " + registerName(line.operand(0)) + ", " + registerName(line.operand(1));
+	if (m == "MVI") return "LD " + registerName(line.operand(0)) + ", " + line.operand(1);
+	if (m == "LXI") return "LD " + pairName(line.operand(0)) + ", " + line.operand(1);
+	if (m == "LDA") return "LD A, (" + line.operand(0) + ")";
+	if (m == "STA") return "LD (" + line.operand(0) + "), A";
+	if (m == "LHLD") return "LD HL, (" + line.operand(0) + ")";
+	if (m == "SHLD") return "LD (" + line.operand(0) + "), HL";
+	if (m == "LDAX") return "LD A, (" + pairName(line.operand(0)) + ")";
+	if (m == "STAX") return "LD (" + pairName(line.operand(0)) + "), A";
+	if (m == "INR") return "INC " + registerName(line.operand(0));
+	if (m == "DCR") return "DEC " + registerName(line.operand(0));
+	if (m == "INX") return "INC " + pairName(line.operand(0));
+	if (m == "DCX") return "DEC " + pairName(line.operand(0));
+	if (m == "DAD") return "ADD HL, " + pairName(line.operand(0));
+	if (m == "PUSH" || m == "POP") return m + " " + pairName(line.operand(0));
+	if (m == "IN") return "IN A, (" + line.operand(0) + ")";
+	if (m == "OUT") return "OUT (" + line.operand(0) + "), A";
+	if (m == "RST") return "RST " + std::to_string(8 * std::stoi(line.operand(0)));
+	if (m == "JMP") return "JP " + line.operand(0);
+	if (m == "CALL") return "CALL " + line.operand(0);
+	auto kind = branch(m);
+	if (kind == "J") return "JP " + m.substr(1) + ", " + line.operand(0);
+	if (kind == "C") return "CALL " + m.substr(1) + ", " + line.operand(0);
+	if (kind == "R") return "RET " + m.substr(1);
+	return "";
+}
+
+static std::string lower(const AssemblyLine& line) {
+	if (line.mnemonic.empty() || directives.count(line.mnemonic)) return line.text;
+	auto instruction = zilog(line);
+	return instruction.empty() ? line.text : join(line, instruction);
+}
+
+static bool isRegister(const std::string& operand) {
+	return operand.size() == 1 && std::string("ABCDEHL").find(operand) != std::string::npos;
+}
+
+static bool isIndexed(const std::string& operand) {
+	return operand.rfind("(IX", 0) == 0;
+}
+
+static const std::set<std::string> zilogArithmetic = {"ADD", "ADC", "SUB", "SBC", "AND", "XOR", "OR", "CP"};
+
+static const std::set<std::string> zilogMnemonics = {
+		"LD", "ADD", "ADC", "SUB", "SBC", "AND", "XOR", "OR", "CP", "INC", "DEC", "EX", "JP", "JR", "DJNZ", "CALL",
+		"RET", "RST", "PUSH", "POP", "IN", "OUT", "RLCA", "RRCA", "RLA", "RRA", "CPL", "CCF", "SCF", "DAA", "NOP",
+		"HALT", "EI", "DI", "CPIR", "OTIR", "LDIR"
+};
+
+size_t Z80Target::instructionSize(const std::string& text) const {
+	auto line = split(text);
+	const auto& m = line.mnemonic;
+	if (!zilogMnemonics.count(m)) return Assembly::instructionSize(text);
+	bool indexed = std::any_of(line.operands.begin(), line.operands.end(), isIndexed);
+	auto first = line.operand(0);
+	auto second = line.operand(1);
+	if (m == "LD") {
+		if (indexed) return isRegister(first) || isRegister(second) ? 3 : 4;
+		if (first == "IX") return 4;
+		if (first == "SP" && second == "HL") return 1;
+		if (first == "(HL)") return isRegister(second) ? 1 : 2;
+		if (first == "(BC)" || first == "(DE)") return 1;
+		if (isRegister(first)) {
+			if (isRegister(second) || second == "(HL)" || second == "(BC)" || second == "(DE)") return 1;
+			return second.front() == '(' ? 3 : 2;
+		}
+		// a pair and a word, HL and an address
+		return 3;
+	}
+	if (zilogArithmetic.count(m)) {
+		if (first == "IX") return 2;
+		if (first == "HL") return 1;
+		auto operand = line.operands.empty() ? std::string() : line.operands.back();
+		if (indexed) return 3;
+		return isRegister(operand) || operand == "(HL)" ? 1 : 2;
+	}
+	if (m == "INC" || m == "DEC") return indexed ? 3 : first == "IX" ? 2 : 1;
+	if (m == "JP") return first == "(HL)" ? 1 : 3;
+	if (m == "CALL") return 3;
+	if (m == "PUSH" || m == "POP") return first == "IX" ? 2 : 1;
+	if (m == "JR" || m == "DJNZ" || m == "IN" || m == "OUT" || m == "CPIR" || m == "OTIR" || m == "LDIR") return 2;
+	return 1;
+}
+
+size_t Z80Target::instructionCycles(const std::string& text) const {
+	auto line = split(text);
+	const auto& m = line.mnemonic;
+	if (!zilogMnemonics.count(m)) return 0;
+	bool indexed = std::any_of(line.operands.begin(), line.operands.end(), isIndexed);
+	auto first = line.operand(0);
+	auto second = line.operand(1);
+	if (m == "LD") {
+		if (indexed) return 19;
+		if (first == "IX") return 14;
+		if (first == "SP" && second == "HL") return 6;
+		if (first == "(HL)") return isRegister(second) ? 7 : 10;
+		if (first == "(BC)" || first == "(DE)") return 7;
+		if (isRegister(first)) {
+			if (isRegister(second)) return 4;
+			if (second == "(HL)" || second == "(BC)" || second == "(DE)") return 7;
+			return second.front() == '(' ? 13 : 7;
+		}
+		if (first == "HL" && second.front() == '(') return 16;
+		if (first.front() == '(') return second == "HL" ? 16 : 13;
+		return 10;
+	}
+	if (zilogArithmetic.count(m)) {
+		if (first == "IX") return 15;
+		if (first == "HL") return 11;
+		auto operand = line.operands.empty() ? std::string() : line.operands.back();
+		if (indexed) return 19;
+		return isRegister(operand) ? 4 : 7;
+	}
+	if (m == "INC" || m == "DEC") {
+		if (indexed) return 23;
+		if (first == "(HL)") return 11;
+		if (first == "IX") return 10;
+		return isRegister(first) ? 4 : 6;
+	}
+	if (m == "EX") return first == "(SP)" ? 19 : 4;
+	if (m == "JP") return first == "(HL)" ? 4 : 10;
+	if (m == "JR") return 12;
+	if (m == "DJNZ") return 13;
+	if (m == "CALL") return 17;
+	if (m == "RET") return line.operands.empty() ? 10 : 11;
+	if (m == "RST") return 11;
+	if (m == "PUSH") return first == "IX" ? 15 : 11;
+	if (m == "POP") return first == "IX" ? 14 : 10;
+	if (m == "IN" || m == "OUT") return 11;
+	if (m == "CPIR" || m == "OTIR" || m == "LDIR") return 21;
+	return 4;
+}
+
+static size_t origin(const std::string& operand) {
+	bool hex = !operand.empty() && toupper(operand.back()) == 'H';
+	return std::stoul(hex ? operand.substr(0, operand.size() - 1) : operand, nullptr, hex ? 16 : 10);
+}
+
+// every JP to a label of the code within reach of a JR becomes one, a JR that ends up out of reach
+// turns back into a JP, which only moves the labels further apart
+static void relax(std::vector<std::string>& lines, const Z80Target& target) {
+	std::vector<AssemblyLine> parsed;
+	std::set<std::string> labels;
+	for (const auto& line : lines) {
+		parsed.push_back(split(line));
+		if (!parsed.back().label.empty()) labels.insert(parsed.back().label);
+	}
+	std::vector<bool> near(lines.size(), false);
+	for (size_t i = 0; i < parsed.size(); i++) {
+		const auto& line = parsed[i];
+		if (line.mnemonic != "JP" || !labels.count(line.operands.empty() ? "" : line.operands.back())) continue;
+		near[i] = line.operands.size() == 1 ||
+		          (line.operands.size() == 2 && (line.operands[0] == "Z" || line.operands[0] == "NZ" ||
+		                                         line.operands[0] == "C" || line.operands[0] == "NC"));
+	}
+	for (bool changed = true; changed;) {
+		changed = false;
+		std::vector<size_t> addresses(lines.size(), 0);
+		std::map<std::string, size_t> labelAddresses;
+		size_t address = 0;
+		for (size_t i = 0; i < parsed.size(); i++) {
+			if (parsed[i].mnemonic == "ORG") address = origin(parsed[i].operand(0));
+			if (!parsed[i].label.empty()) labelAddresses[parsed[i].label] = address;
+			addresses[i] = address;
+			address += near[i] ? 2 : target.instructionSize(lines[i]);
+		}
+		for (size_t i = 0; i < parsed.size(); i++) {
+			if (!near[i]) continue;
+			long offset = static_cast<long>(labelAddresses[parsed[i].operands.back()]) -
+			              static_cast<long>(addresses[i] + 2);
+			if (offset < -128 || offset > 127) {
+				near[i] = false;
+				changed = true;
+			}
+		}
+	}
+	for (size_t i = 0; i < parsed.size(); i++) {
+		if (!near[i]) continue;
+		const auto& operands = parsed[i].operands;
+		lines[i] = join(parsed[i], "JR " + (operands.size() == 2 ? operands[0] + ", " : "") + operands.back());
+	}
+}
+
+static std::string joinLines(const std::vector<std::string>& lines) {
+	std::string code;
+	for (const auto& line : lines) code += line + "\n";
+	return code;
+}
+
+std::string Z80Target::name() const {
+	return "z80";
+}
+
+void Z80Target::generateHelpers(std::ostream& stream) const {
+	stream << "@MULT:\n";
+	stream << "; Code for MULT library function\n";
+	// CPIR runs over the terminating zero and leaves the length in the complement of C, OTIR writes it to port 3
+	stream << "@PRINT:\n";
+	stream << "PUSH H\n";
+	stream << "XRA A\n";
+	stream << "MOV B, A\n";
+	stream << "MOV C, A\n";
+	stream << "CPIR\n";
+	stream << "MOV A, C\n";
+	stream << "CMA\n";
+	stream << "POP H\n";
+	stream << "ORA A\n";
+	stream << "JZ PRTEND\n";
+	stream << "MOV B, A\n";
+	stream << "MVI C, 3\n";
+	stream << "OTIR\n";
+	stream << "PRTEND:\n";
+	stream << "MVI A, 10\n";
+	stream << "OUT 3\n";
+	stream << "RET\n";
+}
+
+std::string Z80Target::lowerHeader(const std::string& code) const {
+	std::vector<std::string> lines;
+	std::istringstream iss(code);
+	for (std::string line; std::getline(iss, line);) lines.push_back(lower(split(line)));
+	relax(lines, *this);
+	return joinLines(lines);
+}
+
+// what an 8080 instruction does with a frame address in HL
+enum class AddressUse {
+	NONE, SLOT, READ, DEAD
+};
+
+static AddressUse addressUse(const AssemblyLine& line) {
+	const auto& m = line.mnemonic;
+	const auto& operands = line.operands;
+	bool memory = std::find(operands.begin(), operands.end(), "M") != operands.end();
+	bool halves = std::find(operands.begin(), operands.end(), "H") != operands.end() ||
+	              std::find(operands.begin(), operands.end(), "L") != operands.end();
+	// HL is not kept over a branch, and the helpers take theirs from a LXI right before the call
+	if (!branch(m).empty() || m == "RST" || m == "LHLD") return AddressUse::DEAD;
+	if ((m == "LXI" || m == "POP") && line.operand(0) == "H") return AddressUse::DEAD;
+	if (memory && !halves && (m == "MOV" || m == "MVI" || m == "INR" || m == "DCR" || arithmetic.count(m))) {
+		return AddressUse::SLOT;
+	}
+	if (memory || halves || m == "XCHG" || m == "XTHL" || m == "SPHL" || m == "PCHL" || m == "DAD" ||
+	    m == "SHLD") {
+		return AddressUse::READ;
+	}
+	return AddressUse::NONE;
+}
+
+static std::string displacement(int value) {
+	return "(IX" + std::string(value < 0 ? "-" : "+") + std::to_string(std::abs(value)) + ")";
+}
+
+std::string Z80Target::lowerFunction(const std::string& code) const {
+	std::vector<AssemblyLine> lines;
+	std::set<std::string> labels;
+	std::istringstream iss(code);
+	for (std::string line; std::getline(iss, line);) {
+		lines.push_back(split(line));
+		if (!lines.back().label.empty()) labels.insert(lines.back().label);
+	}
+	// IX keeps the SP of the entry below the saved IX, so a slot rel bytes off the return address
+	// is at IX+rel in the frame and at IX+rel+2 from the return address on
+	std::vector<std::string> out;
+	std::map<size_t, int> slots;
+	bool entered = false;
+	bool body = false;
+	// the bytes pushed since the entry, without the saved IX
+	int depth = 0;
+	int frameDepth = 0;
+	for (size_t i = 0; i < lines.size(); i++) {
+		AssemblyLine line = lines[i];
+		const auto& m = line.mnemonic;
+		if (!line.label.empty()) {
+			// the label goes on a line of its own, the saved IX is popped between it and a RET
+			if (body) depth = frameDepth;
+			out.push_back(line.label + ":" + (m.empty() ? line.comment : ""));
+			line.text = line.text.substr(line.text.find(':') + 1);
+			line.label.clear();
+			if (!entered) {
+				entered = true;
+				out.push_back("PUSH IX");
+				out.push_back("LD IX, 0");
+				out.push_back("ADD IX, SP");
+			}
+			if (m.empty()) continue;
+		}
+		if (m.empty()) {
+			// the prologue ends at the comment of the first atom
+			if (!body && line.text.rfind("\t; (", 0) == 0) {
+				body = true;
+				frameDepth = depth;
+			}
+			out.push_back(line.text);
+			continue;
+		}
+		bool address = m == "LXI" && line.operand(0) == "H" && i + 1 < lines.size() &&
+		               lines[i + 1].label.empty() && lines[i + 1].mnemonic == "DAD" &&
+		               lines[i + 1].operand(0) == "SP";
+		if (address) {
+			int offset = std::stoi(line.operand(1));
+			if (i + 2 < lines.size() && lines[i + 2].label.empty() && lines[i + 2].mnemonic == "SPHL") {
+				// the frame is reserved or released
+				out.push_back(join(line, "LD HL, " + line.operand(1)));
+				out.push_back("ADD HL, SP");
+				out.push_back("LD SP, HL");
+				depth -= offset;
+				i += 2;
+				continue;
+			}
+			int relative = offset - depth;
+			int index = relative < 0 ? relative : relative + 2;
+			// HL is dropped if it only ever addresses the slot
+			// a PUSH H keeps a copy of the address over a call, the matching POP H brings it back
+			std::vector<size_t> uses;
+			std::vector<bool> saved;
+			bool live = true;
+			auto kept = [&saved]() { return std::find(saved.begin(), saved.end(), true) != saved.end(); };
+			bool fused = index >= -128 && index <= 127;
+			for (size_t j = i + 2; fused && j < lines.size() && lines[j].label.empty(); j++) {
+				const auto& next = lines[j];
+				const auto& n = next.mnemonic;
+				if (n.empty()) continue;
+				if (n == "PUSH") {
+					saved.push_back(live && next.operand(0) == "H");
+				} else if (n == "POP") {
+					bool copy = !saved.empty() && saved.back();
+					if (!saved.empty()) saved.pop_back();
+					if (next.operand(0) == "H") live = copy;
+					else if (copy) fused = false;
+				} else if (kept() && (n == "SPHL" || n == "XTHL" || (n != "DAD" && next.operand(0) == "SP") ||
+				                      (!branch(n).empty() && branch(n) != "C"))) {
+					// the copy is only followed over straight-line code with a balanced stack
+					fused = false;
+				} else if (live) {
+					auto use = addressUse(next);
+					if (use == AddressUse::SLOT) uses.push_back(j);
+					if (use == AddressUse::READ) fused = false;
+					if (use == AddressUse::DEAD) live = false;
+				}
+				if (!live && !kept()) break;
+			}
+			if (kept()) fused = false;
+			if (fused) {
+				for (size_t use : uses) slots[use] = index;
+			} else {
+				out.push_back(join(line, "LD HL, " + std::to_string(index + depth)));
+				out.push_back("ADD HL, SP");
+			}
+			i++;
+			continue;
+		}
+		auto slot = slots.find(i);
+		if (slot != slots.end()) {
+			AssemblyLine indexed = line;
+			std::replace(indexed.operands.begin(), indexed.operands.end(), std::string("M"),
+			             displacement(slot->second));
+			out.push_back(join(indexed, zilog(indexed)));
+			continue;
+		}
+		// a tail call jumps out of the function
+		bool exit = m == "RET" || (m == "JMP" && !labels.count(line.operand(0)));
+		if (exit) out.push_back("POP IX");
+		out.push_back(lower(line));
+		if (m == "PUSH") depth += 2;
+		if (m == "POP") depth -= 2;
+		if (exit || m == "JMP") depth = frameDepth;
+	}
+	relax(out, *this);
+	return joinLines(out);
+}
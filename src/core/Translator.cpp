@@ -5,9 +5,18 @@
 #include "../include/Translator.h"
 
 #include <algorithm>
+#include <climits>
+#include <iomanip>
 #include <sstream>
 #include <utility>
+#include "../include/Assembly.h"
+#include "../include/BlockLayout.h"
+#include "../include/CallGraph.h"
+#include "../include/ControlFlowGraph.h"
 #include "../include/GlobalParameters.h"
+#include "../include/Liveness.h"
+#include "../include/Optimizer.h"
+#include "../include/Target.h"
 
 
 Translator::Translator(std::istream& inputStream) : _scanner(Scanner(inputStream)) {
@@ -31,8 +40,40 @@ void Translator::printStringTable(std::ostream& stream) {
 	_stringTable.printStringTable(stream);
 }
 
+void Translator::printOptimizationReport(std::ostream& stream) {
+	stream << "OPTIMIZATION REPORT:" << std::endl;
+	for (size_t i = 0; i < 64; i++) stream << "-";
+	stream << std::endl;
+	for (const auto& scope : _hoistedAtoms) {
+		for (const auto& loop : scope.second) {
+			stream << "scope " << scope.first << ", loop L" << loop.first << ": hoisted " << loop.second
+			       << " atom" << (loop.second == 1 ? "" : "s") << std::endl;
+		}
+	}
+	for (const auto& function : _symbolTable.functionNames()) {
+		size_t slots = _symbolTable.getM(function.second);
+		size_t locals = _symbolTable.getLocalCount(function.second);
+		if (_unreachableFunctions.count(function.second) || slots >= locals) continue;
+		stream << "function " << function.first << ": " << slots << " frame slot" << (slots == 1 ? "" : "s")
+		       << " for " << locals << " locals and temps" << std::endl;
+	}
+	for (Scope function : _unreachableFunctions) {
+		stream << "function " << _symbolTable._records[function]._name << ": unreachable from main" << std::endl;
+	}
+	for (const auto& rule : _peephole.hits()) {
+		if (rule.second == 0) continue;
+		stream << "peephole " << rule.first << ": " << rule.second << " hit" << (rule.second == 1 ? "" : "s")
+		       << std::endl;
+	}
+	if (_removedBytes > 0) {
+		stream << "removed " << _removedBytes << " byte" << (_removedBytes == 1 ? "" : "s")
+		       << " of unreachable code and data" << std::endl;
+	}
+}
+
 void Translator::generateAtoms(Scope scope, const std::shared_ptr<Atom>& atom) {
 	_atoms.emplace(scope, std::vector<std::shared_ptr<Atom>>());
+	if (atom->line() == 0) atom->setLine(_scanner.getRowPos());
 	_atoms[scope].push_back(atom);
 }
 
@@ -126,13 +167,20 @@ std::shared_ptr<RValue> Translator::E7(Scope scope) {
 std::shared_ptr<RValue> Translator::E7_(Scope scope, std::shared_ptr<RValue> p) {
 	getAndCheckLexeme(true);
 	if (_currentLexeme.type() == LexemType::opor) { // 1_3
+		// logical: 1 or 0, the right operand is skipped once the left one holds
 		auto s = _symbolTable.alloc(scope);
+		auto l = newLabel();
+		auto zero = std::make_shared<NumberOperand>(0);
+		generateAtoms(scope, std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(1), s));
+		generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("NE", p, zero, l));
 		auto r = E6(scope);
 		if (!r) {
 			syntaxError("Error during syntax analysis on rule E6");
 			return nullptr;
 		}
-		generateAtoms(scope, std::make_shared<BinaryOpAtom>("OR", p, r, s));
+		generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("NE", r, zero, l));
+		generateAtoms(scope, std::make_shared<UnaryOpAtom>("MOV", zero, s));
+		generateAtoms(scope, std::make_shared<LabelAtom>(l));
 		auto t = E7_(scope, s);
 		if (!t) {
 			syntaxError("Error during syntax analysis on rule E7_");
@@ -163,13 +211,20 @@ std::shared_ptr<RValue> Translator::E6(Scope scope) {
 std::shared_ptr<RValue> Translator::E6_(Scope scope, std::shared_ptr<RValue> p) {
 	getAndCheckLexeme(true);
 	if (_currentLexeme.type() == LexemType::opand) { // 1_6
+		// logical: 1 or 0, the right operand is skipped once the left one fails
 		auto s = _symbolTable.alloc(scope);
+		auto l = newLabel();
+		auto zero = std::make_shared<NumberOperand>(0);
+		generateAtoms(scope, std::make_shared<UnaryOpAtom>("MOV", zero, s));
+		generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("EQ", p, zero, l));
 		auto r = E5(scope);
 		if (!r) {
 			syntaxError("Error during syntax analysis on rule E5");
 			return nullptr;
 		}
-		generateAtoms(scope, std::make_shared<BinaryOpAtom>("AND", p, r, s));
+		generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("EQ", r, zero, l));
+		generateAtoms(scope, std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(1), s));
+		generateAtoms(scope, std::make_shared<LabelAtom>(l));
 		auto t = E6_(scope, s);
 		if (!t) {
 			syntaxError("Error during syntax analysis on rule E6_");
@@ -243,6 +298,125 @@ std::shared_ptr<RValue> Translator::E5_(Scope scope, std::shared_ptr<RValue> p)
 	}
 }
 
+bool Translator::CondE7(Scope scope, const std::shared_ptr<LabelOperand>& falseLabel) {
+	// jumping code for E7 used as a condition: falls through when true, jumps to falseLabel when false
+	auto trueLabel = newLabel();
+	bool referenced = false;
+	while (true) {
+		size_t start = _atoms[scope].size();
+		auto skip = CondE6(scope, trueLabel);
+		getAndCheckLexeme(true);
+		if (_currentLexeme.type() == LexemType::opor) {
+			referenced = true;
+			continue;
+		}
+		pushBackLexeme();
+		retargetCondition(scope, start, skip, trueLabel, falseLabel);
+		break;
+	}
+	if (referenced) {
+		generateAtoms(scope, std::make_shared<LabelAtom>(trueLabel));
+	}
+	return true;
+}
+
+std::shared_ptr<LabelOperand> Translator::CondE6(Scope scope, const std::shared_ptr<LabelOperand>& trueLabel) {
+	// jumps to trueLabel when every operand holds, returns the label of the failure exit if one was needed
+	auto skip = newLabel();
+	bool referenced = false;
+	while (true) {
+		if (!CondE5(scope, skip)) {
+			syntaxError("Error during syntax analysis on rule E5");
+			return nullptr;
+		}
+		getAndCheckLexeme(true);
+		if (_currentLexeme.type() == LexemType::opand) {
+			referenced = true;
+			continue;
+		}
+		pushBackLexeme();
+		invertLastJump(scope, trueLabel);
+		break;
+	}
+	if (!referenced) return nullptr;
+	generateAtoms(scope, std::make_shared<LabelAtom>(skip));
+	return skip;
+}
+
+bool Translator::CondE5(Scope scope, const std::shared_ptr<LabelOperand>& falseLabel) {
+	auto p = E4(scope);
+	if (!p) {
+		syntaxError("Error during syntax analysis on rule E4");
+		return false;
+	}
+	getAndCheckLexeme(true);
+	std::string condition;
+	switch (_currentLexeme.type()) {
+		case LexemType::opeq:
+			condition = "EQ";
+			break;
+		case LexemType::opne:
+			condition = "NE";
+			break;
+		case LexemType::opgt:
+			condition = "GT";
+			break;
+		case LexemType::oplt:
+			condition = "LT";
+			break;
+		case LexemType::ople:
+			condition = "LE";
+			break;
+		default:
+			break;
+	}
+	if (condition.empty()) {
+		pushBackLexeme();
+		generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("EQ", p, std::make_shared<NumberOperand>(0),
+		                                                           falseLabel));
+		return true;
+	}
+	auto r = E4(scope);
+	if (!r) {
+		syntaxError("Error during syntax analysis on rule E4");
+		return false;
+	}
+	generateAtoms(scope, std::make_shared<ConditionalJumpAtom>(ConditionalJumpAtom::invertCondition(condition),
+	                                                           p, r, falseLabel));
+	return true;
+}
+
+void Translator::invertLastJump(Scope scope, const std::shared_ptr<LabelOperand>& label) {
+	auto& atoms = _atoms[scope];
+	auto jump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms.back());
+	atoms.back() = std::make_shared<ConditionalJumpAtom>(ConditionalJumpAtom::invertCondition(jump->condition()),
+	                                                     jump->left(), jump->right(), label);
+}
+
+void Translator::retargetCondition(Scope scope, size_t start, const std::shared_ptr<LabelOperand>& skip,
+                                   const std::shared_ptr<LabelOperand>& trueLabel,
+                                   const std::shared_ptr<LabelOperand>& falseLabel) {
+	// the last operand of an || chain was generated as "jump to trueLabel if it holds";
+	// being last, it can jump to falseLabel on failure instead and fall through on success
+	auto& atoms = _atoms[scope];
+	for (size_t i = start; i < atoms.size();) {
+		auto label = std::dynamic_pointer_cast<LabelAtom>(atoms[i]);
+		if (label && skip && label->label()->labelId() == skip->labelId()) {
+			atoms.erase(atoms.begin() + i);
+			continue;
+		}
+		auto jump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atoms[i]);
+		if (jump && skip && jump->label()->labelId() == skip->labelId()) {
+			atoms[i] = std::make_shared<ConditionalJumpAtom>(jump->condition(), jump->left(), jump->right(),
+			                                                 falseLabel);
+		} else if (jump && jump->label()->labelId() == trueLabel->labelId()) {
+			atoms[i] = std::make_shared<ConditionalJumpAtom>(ConditionalJumpAtom::invertCondition(jump->condition()),
+			                                                 jump->left(), jump->right(), falseLabel);
+		}
+		i++;
+	}
+}
+
 std::shared_ptr<RValue> Translator::E4(Scope scope) {
 	// 1_15
 	auto q = E3(scope);
@@ -780,6 +954,25 @@ bool Translator::AssignOrCall_(Scope scope, const std::string& p) {
 bool Translator::WhileOp(Scope scope) { // 2_32
 	auto l1 = newLabel();
 	auto l2 = newLabel();
+	if (GlobalParameters::getInstance().optimizationLevel > 0) {
+		// rotated: guard test, body, then the test again as the only branch of an iteration
+		getAndCheckLexeme(false, {LexemType::lpar});
+		size_t start = _atoms[scope].size();
+		if (!CondE7(scope, l2)) {
+			syntaxError("Error during syntax analysis on rule E7");
+			return false;
+		}
+		getAndCheckLexeme(false, {LexemType::rpar});
+		std::vector<std::shared_ptr<Atom>> condition(_atoms[scope].begin() + start, _atoms[scope].end());
+		generateAtoms(scope, std::make_shared<LabelAtom>(l1));
+		if (!Stmt(scope)) {
+			syntaxError("Error during syntax analysis on rule Stmt");
+			return false;
+		}
+		generateLoopTest(scope, condition, l2, l1);
+		generateAtoms(scope, std::make_shared<LabelAtom>(l2));
+		return true;
+	}
 	generateAtoms(scope, std::make_shared<LabelAtom>(l1));
 	getAndCheckLexeme(false, {LexemType::lpar});
 	auto p = E(scope);
@@ -800,15 +993,45 @@ bool Translator::WhileOp(Scope scope) { // 2_32
 
 bool Translator::ForOp(Scope scope) { // 2_33
 	getAndCheckLexeme(false, {LexemType::lpar});
-	auto l1 = newLabel();
-	auto l2 = newLabel();
-	auto l3 = newLabel();
-	auto l4 = newLabel();
 	if (!ForInit(scope)) {
 		syntaxError("Error during syntax analysis on rule ForInit");
 		return false;
 	}
 	getAndCheckLexeme(false, {LexemType::semicolon});
+	if (GlobalParameters::getInstance().optimizationLevel > 0) {
+		// rotated: init, guard, body, increment, test, branch back
+		auto l1 = newLabel();
+		auto l4 = newLabel();
+		auto& atoms = _atoms[scope];
+		size_t conditionStart = atoms.size();
+		if (!ForCondition(scope, l4)) {
+			syntaxError("Error during syntax analysis on rule ForExp");
+			return false;
+		}
+		getAndCheckLexeme(false, {LexemType::semicolon});
+		size_t incrementStart = atoms.size();
+		if (!ForLoop(scope)) {
+			syntaxError("Error during syntax analysis on rule ForLoop");
+			return false;
+		}
+		getAndCheckLexeme(false, {LexemType::rpar});
+		std::vector<std::shared_ptr<Atom>> condition(atoms.begin() + conditionStart, atoms.begin() + incrementStart);
+		std::vector<std::shared_ptr<Atom>> increment(atoms.begin() + incrementStart, atoms.end());
+		atoms.erase(atoms.begin() + incrementStart, atoms.end());
+		generateAtoms(scope, std::make_shared<LabelAtom>(l1));
+		if (!Stmt(scope)) {
+			syntaxError("Error during syntax analysis on rule Stmt");
+			return false;
+		}
+		atoms.insert(atoms.end(), increment.begin(), increment.end());
+		generateLoopTest(scope, condition, l4, l1);
+		generateAtoms(scope, std::make_shared<LabelAtom>(l4));
+		return true;
+	}
+	auto l1 = newLabel();
+	auto l2 = newLabel();
+	auto l3 = newLabel();
+	auto l4 = newLabel();
 	generateAtoms(scope, std::make_shared<LabelAtom>(l1));
 	auto p = ForExp(scope);
 	if (!p) {
@@ -835,6 +1058,42 @@ bool Translator::ForOp(Scope scope) { // 2_33
 	return true;
 }
 
+void Translator::generateLoopTest(Scope scope, const std::vector<std::shared_ptr<Atom>>& condition,
+                                  const std::shared_ptr<LabelOperand>& exit, const std::shared_ptr<LabelOperand>& top) {
+	// the condition jumps to exit when false and falls through when true; this copy
+	// gets fresh internal labels and goes back to top when true instead
+	std::map<int, std::shared_ptr<LabelOperand>> labels;
+	for (const auto& atom : condition) {
+		if (auto label = std::dynamic_pointer_cast<LabelAtom>(atom)) {
+			labels[label->label()->labelId()] = newLabel();
+		}
+	}
+	auto relabel = [&labels](const std::shared_ptr<LabelOperand>& label) {
+		auto it = labels.find(label->labelId());
+		return it == labels.end() ? label : it->second;
+	};
+	for (const auto& atom : condition) {
+		if (auto label = std::dynamic_pointer_cast<LabelAtom>(atom)) {
+			generateAtoms(scope, std::make_shared<LabelAtom>(relabel(label->label())));
+		} else if (auto jump = std::dynamic_pointer_cast<JumpAtom>(atom)) {
+			generateAtoms(scope, std::make_shared<JumpAtom>(relabel(jump->label())));
+		} else if (auto conditionalJump = std::dynamic_pointer_cast<ConditionalJumpAtom>(atom)) {
+			generateAtoms(scope, std::make_shared<ConditionalJumpAtom>(conditionalJump->condition(),
+			                                                           conditionalJump->left(),
+			                                                           conditionalJump->right(),
+			                                                           relabel(conditionalJump->label())));
+		} else {
+			generateAtoms(scope, atom);
+		}
+	}
+	auto last = condition.empty() ? nullptr : std::dynamic_pointer_cast<ConditionalJumpAtom>(condition.back());
+	if (last && last->label()->labelId() == exit->labelId()) {
+		invertLastJump(scope, top);
+	} else {
+		generateAtoms(scope, std::make_shared<JumpAtom>(top));
+	}
+}
+
 bool Translator::ForInit(Scope scope) {
 	getAndCheckLexeme(scope);
 	if (_currentLexeme.type() == LexemType::id) { // 2_34
@@ -868,6 +1127,25 @@ std::shared_ptr<RValue> Translator::ForExp(Scope scope) {
 	return std::make_shared<NumberOperand>(1);
 }
 
+bool Translator::ForCondition(Scope scope, const std::shared_ptr<LabelOperand>& falseLabel) {
+	getAndCheckLexeme(false);
+	if (_currentLexeme.type() == LexemType::opnot ||
+	    _currentLexeme.type() == LexemType::lpar ||
+	    _currentLexeme.type() == LexemType::num ||
+	    _currentLexeme.type() == LexemType::chr ||
+	    _currentLexeme.type() == LexemType::opinc ||
+	    _currentLexeme.type() == LexemType::id) {  // 2_36
+		pushBackLexeme();
+		if (!CondE7(scope, falseLabel)) {
+			syntaxError("Error during syntax analysis on rule E7");
+			return false;
+		}
+		return true;
+	}
+	pushBackLexeme();   // 2_37
+	return true;
+}
+
 bool Translator::ForLoop(Scope scope) {
 	getAndCheckLexeme(false);
 	if (_currentLexeme.type() == LexemType::id) { // 2_38
@@ -891,13 +1169,21 @@ bool Translator::IfOp(Scope scope) {
 	getAndCheckLexeme(false, {LexemType::lpar}); // 2_41
 	auto l1 = newLabel();
 	auto l2 = newLabel();
-	auto p = E(scope);
-	if (!p) {
-		syntaxError("Error during syntax analysis on rule E");
-		return false;
+	if (GlobalParameters::getInstance().optimizationLevel > 0) {
+		if (!CondE7(scope, l1)) {
+			syntaxError("Error during syntax analysis on rule E7");
+			return false;
+		}
+		getAndCheckLexeme(false, {LexemType::rpar});
+	} else {
+		auto p = E(scope);
+		if (!p) {
+			syntaxError("Error during syntax analysis on rule E");
+			return false;
+		}
+		getAndCheckLexeme(false, {LexemType::rpar});
+		generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("EQ", p, std::make_shared<NumberOperand>(0), l1));
 	}
-	getAndCheckLexeme(false, {LexemType::rpar});
-	generateAtoms(scope, std::make_shared<ConditionalJumpAtom>("EQ", p, std::make_shared<NumberOperand>(0), l1));
 	if (!Stmt(scope)) {
 		syntaxError("Error during syntax analysis on rule Stmt");
 		return false;
@@ -935,6 +1221,21 @@ bool Translator::SwitchOp(Scope scope) {
 	}
 	getAndCheckLexeme(false, {LexemType::rpar});
 	getAndCheckLexeme(false, {LexemType::lbrace});
+	if (GlobalParameters::getInstance().optimizationLevel > 0) {
+		// all case constants go into one SWITCH placed before the case bodies
+		size_t position = _atoms[scope].size();
+		SwitchAtom::Cases cases;
+		std::shared_ptr<LabelOperand> def;
+		if (!SwitchCases(scope, cases, def, end)) {
+			syntaxError("Error during syntax analysis on rule Cases");
+			return false;
+		}
+		getAndCheckLexeme(false, {LexemType::rbrace});
+		auto& atoms = _atoms[scope];
+		atoms.insert(atoms.begin() + position, std::make_shared<SwitchAtom>(p, cases, def ? def : end));
+		generateAtoms(scope, std::make_shared<LabelAtom>(end));
+		return true;
+	}
 	if (!Cases(scope, p, end)) {
 		syntaxError("Error during syntax analysis on rule Cases");
 		return false;
@@ -998,6 +1299,33 @@ bool Translator::Cases_(Scope scope, const std::shared_ptr<RValue>& p, const std
 	return true;
 }
 
+bool Translator::SwitchCases(Scope scope, SwitchAtom::Cases& cases, std::shared_ptr<LabelOperand>& def,
+                             const std::shared_ptr<LabelOperand>& end) {
+	getAndCheckLexeme(false, {LexemType::kwcase, LexemType::kwdefault});
+	while (_currentLexeme.type() == LexemType::kwcase || _currentLexeme.type() == LexemType::kwdefault) {
+		auto label = newLabel();
+		if (_currentLexeme.type() == LexemType::kwcase) {
+			getAndCheckLexeme(false, {LexemType::num});
+			cases.emplace_back(_currentLexeme.value(), label);
+		} else if (def) {
+			syntaxError("Two default section");
+			return false;
+		} else {
+			def = label;
+		}
+		getAndCheckLexeme(false, {LexemType::colon});
+		generateAtoms(scope, std::make_shared<LabelAtom>(label));
+		if (!Stmt(scope)) {
+			syntaxError("Error during syntax analysis on rule Stmt");
+			return false;
+		}
+		generateAtoms(scope, std::make_shared<JumpAtom>(end));
+		getAndCheckLexeme(false);
+	}
+	pushBackLexeme();
+	return true;
+}
+
 std::shared_ptr<LabelOperand>
 Translator::ACase(Scope scope, const std::shared_ptr<RValue>& p, const std::shared_ptr<LabelOperand>& end) {
 	getAndCheckLexeme(false, {LexemType::kwcase, LexemType::kwdefault});
@@ -1085,7 +1413,85 @@ void Translator::startTranslation() {
 	if (_symbolTable.checkFunc("main", 0) == nullptr) {
 		syntaxError("A main function with 0 arguments expected, but it's not provided.");
 	}
+	optimize();
 	_symbolTable.calculateOffset();
+	if (!_profile.empty()) layoutBlocks();
+}
+
+void Translator::setProfile(std::map<std::pair<std::string, int>, size_t> profile) {
+	_profile = std::move(profile);
+}
+
+size_t Translator::functionHits(const std::string& function) const {
+	size_t out = 0;
+	for (auto it = _profile.lower_bound({function, INT_MIN}); it != _profile.end() && it->first.first == function; ++it) {
+		out += it->second;
+	}
+	return out;
+}
+
+void Translator::layoutBlocks() {
+	// the atom indices of the profile are those of the optimized atoms, a function it never reached keeps its order
+	for (const auto& function : _symbolTable.functionNames()) {
+		auto atoms = _atoms.find(function.second);
+		if (atoms == _atoms.end() || functionHits(function.first) == 0) continue;
+		std::map<int, size_t> hits;
+		for (auto it = _profile.lower_bound({function.first, INT_MIN});
+		     it != _profile.end() && it->first.first == function.first; ++it) {
+			hits[it->first.second] = it->second;
+		}
+		BlockLayout(*this, hits).run(atoms->second);
+	}
+}
+
+void Translator::optimize() {
+	Optimizer optimizer(_atoms, _symbolTable, *this);
+	optimizer.run();
+	_hoistedAtoms = optimizer.hoistedAtoms();
+	if (GlobalParameters::getInstance().optimizationLevel > 0) pruneCallGraph();
+}
+
+void Translator::pruneCallGraph() {
+	// only functions reachable from main are emitted, with the globals and strings they refer to
+	Scope main = -1;
+	for (const auto& function : _symbolTable.functionNames()) {
+		if (function.first == "main") main = function.second;
+	}
+	if (main == -1) return;
+	auto reachable = CallGraph(_atoms).reachable(main);
+	_liveRecords.assign(_symbolTable.size(), false);
+	_liveStrings.assign(_stringTable.size(), false);
+	for (const auto& pair : _atoms) {
+		if (!reachable.count(pair.first)) {
+			_unreachableFunctions.insert(pair.first);
+			continue;
+		}
+		for (const auto& atom : pair.second) {
+			auto operands = atom->uses();
+			if (atom->def()) operands.push_back(atom->def());
+			for (const auto& operand : operands) {
+				auto memory = std::dynamic_pointer_cast<MemoryOperand>(operand);
+				if (memory) _liveRecords[memory->index()] = true;
+			}
+			auto out = std::dynamic_pointer_cast<OutAtom>(atom);
+			auto string = out ? std::dynamic_pointer_cast<StringOperand>(out->value()) : nullptr;
+			if (string) _liveStrings[string->index()] = true;
+		}
+	}
+	// the removed size is measured on the code that would have been emitted
+	auto switchCount = codeGenSwitchCount;
+	auto skipLabels = codeGenSkipLabels;
+	std::ostringstream all, live;
+	_symbolTable.generateGlobals(all);
+	_symbolTable.generateGlobals(live, _liveRecords);
+	_stringTable.generateStrings(all);
+	_stringTable.generateStrings(live, _liveStrings);
+	for (Scope function : _unreachableFunctions) {
+		generateFunction(all, {_symbolTable._records[function]._name, function});
+	}
+	_removedBytes = Assembly::size(all.str()) - Assembly::size(live.str());
+	codeGenSwitchCount = switchCount;
+	codeGenSkipLabels = skipLabels;
 }
 
 const SymbolTable& Translator::getSymbolTable() const {
@@ -1138,44 +1544,369 @@ std::shared_ptr<MemoryOperand> Translator::checkFunc(const std::string& name, in
 	return out;
 }
 
-void Translator::generateProlog(std::ostream &stream) {
+void Translator::generateProlog(std::ostream &stream, const std::map<std::string, int>& helperVectors) {
     stream << "ORG 0\n";
     stream << "LXI H, 0\n";
     stream << "SPHL\n";
     stream << "CALL main\n";
     stream << "END\n";
-    stream << "@MULT:\n";
-    stream << "; Code for MULT library function\n";
-    stream << "@PRINT:\n";
-    stream << "; Code for PRINT library function\n";
+	// RST n calls address 8n, the vector jumps on to the helper
+	std::map<int, std::string> vectors;
+	for (const auto& helper : helperVectors) vectors[helper.second] = helper.first;
+	for (const auto& vector : vectors) {
+		stream << "ORG " + std::to_string(8 * vector.first) + "\n";
+		stream << "JMP " + vector.second + "\n";
+	}
+	Target::current().generateHelpers(stream);
+}
+
+void Translator::generateProfileDump(std::ostream& stream, size_t counters) {
+	// writes the counters byte by byte to port 2, main calls it before it returns
+	stream << "@PROFILE:\n";
+	stream << "LXI H, prf0\n";
+	stream << "LXI D, " + std::to_string(2 * counters) + "\n";
+	stream << "PRFLOOP:\n";
+	stream << "MOV A, M\n";
+	stream << "OUT 2\n";
+	stream << "INX H\n";
+	stream << "DCX D\n";
+	stream << "MOV A, D\n";
+	stream << "ORA E\n";
+	stream << "JNZ PRFLOOP\n";
+	stream << "RET\n";
 }
 
 void Translator::generateFunction(std::ostream &stream, const std::pair<std::string, int>& par) {
     stream << "\n" + par.first + ":\n";
-    stream << "LXI B, 0\n";
-    auto m = _symbolTable.getM(par.second);
-    for(int i = 0; i < m; i++) stream << "PUSH B\n";
-    for(const auto& atom : _atoms[par.second]) {
-	    atom->generate(stream, this, par.second);
+    if (GlobalParameters::getInstance().byteFrames) {
+	    reserveFrame(stream, par.second);
+    } else {
+	    stream << "LXI B, 0\n";
+	    auto m = _symbolTable.getM(par.second);
+	    for (int i = 0; i < m; i++) stream << "PUSH B\n";
     }
+	const auto& atoms = _atoms[par.second];
+	for (size_t i = 0; i < atoms.size(); i++) {
+		if (!GlobalParameters::getInstance().profileGenerate) {
+			atoms[i]->generate(stream, this, par.second);
+			continue;
+		}
+		std::ostringstream code;
+		atoms[i]->generate(code, this, par.second);
+		stream << instrument(par, i, code.str());
+	}
+}
+
+std::string Translator::callHelper(const std::string& helper) const {
+	auto it = _helperVectors.find(helper);
+	return it == _helperVectors.end() ? "CALL " + helper + "\n" : "RST " + std::to_string(it->second) + "\n";
+}
+
+void Translator::assignHelperVectors() {
+	// a vector costs a 3-byte JMP and every RST saves 2 bytes over a CALL, so a helper needs two call sites;
+	// the vectors go to the helpers called most often, by the profile if there is one
+	std::map<std::string, size_t> sites;
+	std::map<std::string, size_t> frequency;
+	for (const auto& function : _emittedFunctions) {
+		const auto& atoms = _atoms[function.second];
+		for (size_t i = 0; i < atoms.size(); i++) {
+			std::string helper;
+			if (auto binary = std::dynamic_pointer_cast<BinaryOpAtom>(atoms[i])) {
+				if (binary->name() == "MUL") helper = "@MULT";
+				if (binary->name() == "DIV") helper = "@DIV";
+			} else if (auto out = std::dynamic_pointer_cast<OutAtom>(atoms[i])) {
+				if (out->value()->toString()[0] == 'S') helper = "@PRINT";
+			}
+			if (helper.empty()) continue;
+			sites[helper]++;
+			if (_profile.empty()) {
+				frequency[helper]++;
+			} else {
+				auto hits = _profile.find({function.first, static_cast<int>(i)});
+				if (hits != _profile.end()) frequency[helper] += hits->second;
+			}
+		}
+	}
+	std::vector<std::string> helpers;
+	for (const auto& helper : sites) {
+		if (helper.second >= 2) helpers.push_back(helper.first);
+	}
+	std::stable_sort(helpers.begin(), helpers.end(), [&frequency](const std::string& a, const std::string& b) {
+		return frequency[a] > frequency[b];
+	});
+	// RST 0 is the reset at the prolog
+	_helperVectors.clear();
+	for (size_t i = 0; i < helpers.size() && i < 7; i++) _helperVectors[helpers[i]] = static_cast<int>(i) + 1;
+}
+
+void Translator::allocateCounters(const std::vector<std::pair<std::string, int>>& functions) {
+	// a counter for every block entry and every call site
+	_counters.clear();
+	_counterAtoms.clear();
+	for (const auto& function : functions) {
+		const auto& atoms = _atoms[function.second];
+		ControlFlowGraph graph(atoms);
+		int index = 0;
+		for (size_t block = 0; block < graph.size(); block++) {
+			_counterAtoms[function.second].emplace(index, _counters.size());
+			_counters.push_back({function.first, index, ""});
+			index += static_cast<int>(graph[block].atoms.size());
+		}
+		for (size_t i = 0; i < atoms.size(); i++) {
+			std::shared_ptr<MemoryOperand> callee;
+			if (auto call = std::dynamic_pointer_cast<CallAtom>(atoms[i])) callee = call->function();
+			if (auto tailCall = std::dynamic_pointer_cast<TailCallAtom>(atoms[i])) callee = tailCall->function();
+			if (!callee) continue;
+			_counterAtoms[function.second].emplace(static_cast<int>(i), _counters.size());
+			_counters.push_back({function.first, static_cast<int>(i), _symbolTable._records[callee->index()]._name});
+		}
+	}
+}
+
+std::string Translator::instrument(const std::pair<std::string, int>& function, size_t index,
+                                   const std::string& code) {
+	// the increments go behind the label of a LBL and behind the comment of any other atom
+	const auto& atom = _atoms[function.second][index];
+	std::string increments;
+	auto counters = _counterAtoms[function.second].equal_range(static_cast<int>(index));
+	for (auto it = counters.first; it != counters.second; ++it) {
+		std::string counter = "prf" + std::to_string(it->second);
+		increments += "LHLD " + counter + "\nINX H\nSHLD " + counter + "\n";
+	}
+	if (function.first == "main" && std::dynamic_pointer_cast<RetAtom>(atom)) increments += "CALL @PROFILE\n";
+	if (increments.empty()) return code;
+	size_t at = 0;
+	if (std::dynamic_pointer_cast<LabelAtom>(atom)) {
+		at = code.size();
+	} else if (code.rfind("\t; ", 0) == 0) {
+		at = code.find('\n') + 1;
+	}
+	return code.substr(0, at) + increments + code.substr(at);
+}
+
+const std::vector<Translator::ProfileCounter>& Translator::counters() const {
+	return _counters;
+}
+
+void Translator::reserveFrame(std::ostream& stream, Scope scope) {
+	// the frame is not cleared, only the locals read before their first write are zeroed
+	auto frame = _symbolTable.getFrameSize(scope);
+	if (frame > 0) {
+		stream << "LXI H, -" + std::to_string(frame) + "\n";
+		stream << "DAD SP\n";
+		stream << "SPHL\n";
+	}
+	ControlFlowGraph graph(_atoms[scope]);
+	if (graph.size() == 0) return;
+	Liveness liveness(_symbolTable, graph);
+	int parameters = _symbolTable._records[scope]._len;
+	for (size_t i = 0; i < _symbolTable.size(); i++) {
+		const auto& record = _symbolTable._records[i];
+		if (record._scope != scope || record._kind != SymbolTable::TableRecord::RecordKind::var) continue;
+		if (parameters-- > 0 || record._offset < 0 || !liveness.liveIn(0).test(i)) continue;
+		stream << "LXI H, " + std::to_string(record._offset) + "\n";
+		stream << "DAD SP\n";
+		stream << "MVI M, 0\n";
+	}
 }
 
 void Translator::generateCode(std::ostream &stream) {
 	if (GlobalParameters::getInstance().printAsmHeader) {
-		stream << "ASM 8080 code:" << std::endl;
+		stream << "ASM " << Target::current().name() << " code:" << std::endl;
 		for (size_t i = 0; i < 64; i++) stream << "-";
 		stream << std::endl;
 	}
-	stream << "ORG 8000H\n";
-	_symbolTable.generateGlobals(stream);
-	_stringTable.generateStrings(stream);
-	generateProlog(stream);
 	auto funcs = _symbolTable.functionNames();
+	if (!_profile.empty()) {
+		// the hottest functions first, the ones the profile never reached last
+		std::stable_sort(funcs.begin(), funcs.end(), [this](const auto& a, const auto& b) {
+			return functionHits(a.first) > functionHits(b.first);
+		});
+	}
+	_emittedFunctions.clear();
 	for (const auto& func : funcs) {
-		generateFunction(stream, func);
+		if (!_unreachableFunctions.count(func.second)) _emittedFunctions.push_back(func);
+	}
+	bool instrumented = GlobalParameters::getInstance().profileGenerate;
+	if (instrumented) allocateCounters(_emittedFunctions);
+	std::ostringstream header;
+	header << "ORG 8000H\n";
+	_symbolTable.generateGlobals(header, _liveRecords);
+	_stringTable.generateStrings(header, _liveStrings);
+	if (instrumented) {
+		for (size_t i = 0; i < _counters.size(); i++) header << "prf" << i << ": DW 0\n";
+	}
+	if (GlobalParameters::getInstance().rstHelpers) assignHelperVectors();
+	generateProlog(header, _helperVectors);
+	if (instrumented) generateProfileDump(header, _counters.size());
+	// the target lowers the 8080 code once the peephole is done with it
+	const auto& target = Target::current();
+	_headerCode = target.lowerHeader(header.str());
+	stream << _headerCode;
+	for (const auto& func : _emittedFunctions) {
+		std::ostringstream function;
+		generateFunction(function, func);
+		auto& code = _functionCode[func.second];
+		code = GlobalParameters::getInstance().optimizationLevel <= 0 ? function.str() : _peephole.run(function.str());
+		code = target.lowerFunction(code);
+		stream << code;
+	}
+}
+
+void Translator::printPerformanceReport(std::ostream& stream) {
+	// straight-line T-states of every atom-level basic block of the generated code, a loop is
+	// assumed to run 10 times, so a block is weighted by 10 to the power of its nesting depth
+	stream << "PERFORMANCE REPORT:" << std::endl;
+	for (size_t i = 0; i < 64; i++) stream << "-";
+	stream << std::endl;
+	for (const auto& function : _functionCode) {
+		const auto& atoms = _atoms[function.first];
+		ControlFlowGraph graph(atoms);
+		std::vector<size_t> blockOf;
+		for (size_t block = 0; block < graph.size(); block++) {
+			blockOf.insert(blockOf.end(), graph[block].atoms.size(), block);
+		}
+		std::vector<size_t> depth(graph.size(), 0);
+		for (const auto& loop : graph.loops()) {
+			for (size_t block : loop.blocks) depth[block]++;
+		}
+		// the prologue goes to the first block
+		std::vector<size_t> bytes(std::max<size_t>(graph.size(), 1), 0);
+		std::vector<size_t> cycles(bytes.size(), 0);
+		auto owners = lineAtoms(function.first, function.second);
+		size_t index = 0;
+		size_t block = 0;
+		std::istringstream iss(function.second);
+		for (std::string line; std::getline(iss, line); index++) {
+			if (owners[index] >= 0 && static_cast<size_t>(owners[index]) < blockOf.size()) block = blockOf[owners[index]];
+			bytes[block] += Target::current().instructionSize(line);
+			cycles[block] += Target::current().instructionCycles(line);
+		}
+		size_t totalBytes = 0;
+		size_t weighted = 0;
+		for (size_t i = 0; i < bytes.size(); i++) {
+			totalBytes += bytes[i];
+			size_t weight = 1;
+			for (size_t k = 0; k < (i < depth.size() ? depth[i] : 0); k++) weight *= 10;
+			weighted += cycles[i] * weight;
+		}
+		stream << "function " << _symbolTable._records[function.first]._name << ": " << totalBytes << " bytes, frame "
+		       << _symbolTable.getFrameSize(function.first) << " bytes, " << weighted << " weighted cycles"
+		       << std::endl;
+		for (size_t i = 0; i < bytes.size(); i++) {
+			stream << "\tblock " << i << ": " << bytes[i] << " bytes, " << cycles[i] << " cycles";
+			if (i < depth.size() && depth[i] > 0) stream << ", loop depth " << depth[i];
+			stream << std::endl;
+		}
 	}
 }
 
+std::vector<int> Translator::lineAtoms(Scope scope, const std::string& code) {
+	// every atom but PARAM starts its code with a comment
+	const auto& atoms = _atoms[scope];
+	std::vector<int> out;
+	int current = -1;
+	size_t next = 0;
+	std::istringstream iss(code);
+	for (std::string line; std::getline(iss, line);) {
+		if (line.rfind("\t; (", 0) == 0) {
+			while (next < atoms.size() && std::dynamic_pointer_cast<ParamAtom>(atoms[next])) next++;
+			current = static_cast<int>(next++);
+		}
+		out.push_back(current);
+	}
+	return out;
+}
+
+static std::string hexAddress(size_t address) {
+	std::ostringstream oss;
+	oss << std::uppercase << std::hex << std::setw(4) << std::setfill('0') << (address & 0xFFFF) << "H";
+	return oss.str();
+}
+
+std::vector<Translator::ListingLine> Translator::listing() {
+	std::vector<ListingLine> out;
+	std::istringstream header(_headerCode);
+	for (std::string line; std::getline(header, line);) out.push_back({line, GLOBAL_SCOPE, "", -1, "", 0});
+	for (const auto& func : _emittedFunctions) {
+		auto it = _functionCode.find(func.second);
+		if (it == _functionCode.end()) continue;
+		const auto& atoms = _atoms[func.second];
+		auto owners = lineAtoms(func.second, it->second);
+		// atoms made up by the optimizer belong to the line of the atom before them
+		size_t row = 0;
+		size_t index = 0;
+		std::istringstream iss(it->second);
+		for (std::string line; std::getline(iss, line); index++) {
+			int atom = owners[index];
+			std::string text;
+			if (atom >= 0 && static_cast<size_t>(atom) < atoms.size()) {
+				if (atoms[atom]->line() != 0) row = atoms[atom]->line();
+				text = atoms[atom]->toString();
+			}
+			out.push_back({line, func.second, func.first, atom, text, row});
+		}
+	}
+	return out;
+}
+
+void Translator::generateMap(std::ostream& stream) {
+	// the location counter follows the ORG directives, a range ends before its second address
+	std::vector<std::pair<std::string, size_t>> symbols;
+	std::ostringstream functions;
+	std::ostringstream lines;
+	size_t address = 0;
+	size_t functionStart = 0;
+	size_t rowStart = 0;
+	const ListingLine *previous = nullptr;
+	auto closeRow = [&]() {
+		if (previous && previous->row != 0 && address > rowStart) {
+			lines << previous->function << " line " << previous->row << ": " << hexAddress(rowStart) << "-"
+			      << hexAddress(address) << std::endl;
+		}
+		rowStart = address;
+	};
+	auto closeFunction = [&]() {
+		if (previous && previous->scope != GLOBAL_SCOPE) {
+			functions << previous->function << ": " << hexAddress(functionStart) << "-" << hexAddress(address)
+			          << std::endl;
+		}
+		functionStart = address;
+	};
+	auto code = listing();
+	for (const auto& line : code) {
+		if (!previous || line.scope != previous->scope) {
+			closeRow();
+			closeFunction();
+		} else if (line.row != previous->row) {
+			closeRow();
+		}
+		previous = &line;
+		std::istringstream iss(line.text);
+		std::string word;
+		iss >> word;
+		if (word == "ORG") {
+			std::string origin;
+			iss >> origin;
+			bool hex = !origin.empty() && toupper(origin.back()) == 'H';
+			address = std::stoul(hex ? origin.substr(0, origin.size() - 1) : origin, nullptr, hex ? 16 : 10);
+			rowStart = functionStart = address;
+			continue;
+		}
+		auto colon = line.text.find(':');
+		if (colon != std::string::npos && colon > 0 && line.text.find_first_of(" \t;") > colon) {
+			symbols.emplace_back(line.text.substr(0, colon), address);
+		}
+		address += Target::current().instructionSize(line.text);
+	}
+	closeRow();
+	closeFunction();
+	stream << "FUNCTIONS:" << std::endl << functions.str() << std::endl;
+	stream << "LINES:" << std::endl << lines.str() << std::endl;
+	stream << "SYMBOLS:" << std::endl;
+	for (const auto& symbol : symbols) stream << symbol.first << ": " << hexAddress(symbol.second) << std::endl;
+}
+
 TranslationException::TranslationException(std::string error) : _error(std::move(error)) {}
 
 const char *TranslationException::what() const noexcept {
@@ -0,0 +1,31 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_ASSEMBLY_H
+#define PROJECT_MICRIC2_ASSEMBLY_H
+
+#include <string>
+#include <vector>
+
+class Assembly {
+public:
+	struct Instruction {
+		std::string mnemonic;
+		std::vector<std::string> operands;
+	};
+
+	// the instruction of one line of the emitted code, an empty mnemonic for labels, comments and directives
+	static Instruction parse(const std::string& line);
+
+	static size_t instructionSize(const std::string& line);
+
+	static size_t size(const std::string& code);
+
+	// T-states, a conditional CALL or RET is counted as taken
+	static size_t instructionCycles(const std::string& line);
+
+	static size_t cycles(const std::string& code);
+};
+
+#endif //PROJECT_MICRIC2_ASSEMBLY_H
@@ -5,8 +5,10 @@
 #ifndef PROJECT_MICRIC2_ATOMS_H
 #define PROJECT_MICRIC2_ATOMS_H
 
+#include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 class SymbolTable;
 
@@ -57,6 +59,8 @@ public:
 
 	std::string toString() const override;
 
+	int value() const noexcept;
+
 	void load(std::ostream& stream, int) const override;
 };
 
@@ -68,6 +72,8 @@ public:
 	StringOperand(size_t index, const StringTable *stringTable);
 
 	std::string toString() const override;
+
+	size_t index() const noexcept;
 };
 
 class LabelOperand : public Operand {
@@ -78,16 +84,29 @@ public:
 
 	std::string toString() const override;
 
+	int labelId() const noexcept;
+
 	bool operator>=(const LabelOperand& rhs) const;
 };
 
 class Atom {
+protected:
+	size_t _line = 0;
 public:
 	Atom();
 
+	// source row the atom was generated for, 0 for atoms made up by the optimizer
+	size_t line() const noexcept;
+
+	void setLine(size_t line);
+
 	virtual std::string toString() const = 0;
 
 	virtual void generate(std::ostream& stream, Translator *translator, int scope) const = 0;
+
+	virtual std::vector<std::shared_ptr<RValue>> uses() const;
+
+	virtual std::shared_ptr<MemoryOperand> def() const;
 };
 
 class BinaryOpAtom : public Atom {
@@ -105,6 +124,18 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	std::shared_ptr<MemoryOperand> def() const override;
+
+	const std::string& name() const noexcept;
+
+	const std::shared_ptr<RValue>& left() const noexcept;
+
+	const std::shared_ptr<RValue>& right() const noexcept;
+
+	const std::shared_ptr<MemoryOperand>& result() const noexcept;
 };
 
 
@@ -121,6 +152,16 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	std::shared_ptr<MemoryOperand> def() const override;
+
+	const std::string& name() const noexcept;
+
+	const std::shared_ptr<RValue>& operand() const noexcept;
+
+	const std::shared_ptr<MemoryOperand>& result() const noexcept;
 };
 
 class OutAtom : public Atom {
@@ -132,6 +173,10 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	const std::shared_ptr<Operand>& value() const noexcept;
 };
 
 class InAtom : public Atom {
@@ -143,6 +188,10 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::shared_ptr<MemoryOperand> def() const override;
+
+	const std::shared_ptr<MemoryOperand>& result() const noexcept;
 };
 
 class LabelAtom : public Atom {
@@ -154,6 +203,8 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	const std::shared_ptr<LabelOperand>& label() const noexcept;
 };
 
 class JumpAtom : public Atom {
@@ -165,6 +216,8 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	const std::shared_ptr<LabelOperand>& label() const noexcept;
 };
 
 class ConditionalJumpAtom : public Atom {
@@ -182,6 +235,62 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	static std::string invertCondition(const std::string& condition);
+
+	const std::string& condition() const noexcept;
+
+	const std::shared_ptr<RValue>& left() const noexcept;
+
+	const std::shared_ptr<RValue>& right() const noexcept;
+
+	const std::shared_ptr<LabelOperand>& label() const noexcept;
+};
+
+class SwitchAtom : public Atom {
+public:
+	typedef std::vector<std::pair<int, std::shared_ptr<LabelOperand>>> Cases;
+
+	enum class Lowering {
+		linear, searchTree, jumpTable
+	};
+
+protected:
+	std::shared_ptr<RValue> _value;
+	Cases _cases;
+	std::shared_ptr<LabelOperand> _default;
+
+	void generateLinear(std::ostream& stream, size_t from, size_t to) const;
+
+	void generateSearchTree(std::ostream& stream, const std::string& name, size_t from, size_t to,
+	                        size_t& nodes) const;
+
+	void generateJumpTable(std::ostream& stream, const std::string& name) const;
+
+public:
+	SwitchAtom(std::shared_ptr<RValue> value, const Cases& cases, std::shared_ptr<LabelOperand> defaultLabel);
+
+	std::string toString() const override;
+
+	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	static Lowering chooseLowering(const Cases& cases, bool forSize);
+
+	const std::shared_ptr<LabelOperand>& target(int value) const;
+
+	std::vector<std::shared_ptr<LabelOperand>> labels() const;
+
+	std::shared_ptr<SwitchAtom> retarget(const std::map<int, std::shared_ptr<LabelOperand>>& labels) const;
+
+	const std::shared_ptr<RValue>& value() const noexcept;
+
+	const Cases& cases() const noexcept;
+
+	const std::shared_ptr<LabelOperand>& defaultLabel() const noexcept;
 };
 
 class CallAtom : public Atom {
@@ -199,6 +308,24 @@ public:
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
 
+	std::shared_ptr<MemoryOperand> def() const override;
+
+	const std::shared_ptr<MemoryOperand>& function() const noexcept;
+
+	const std::shared_ptr<MemoryOperand>& result() const noexcept;
+};
+
+class TailCallAtom : public Atom {
+private:
+	std::shared_ptr<MemoryOperand> _function;
+public:
+	TailCallAtom(std::shared_ptr<MemoryOperand> function);
+
+	std::string toString() const override;
+
+	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	const std::shared_ptr<MemoryOperand>& function() const noexcept;
 };
 
 class RetAtom : public Atom {
@@ -210,6 +337,10 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	const std::shared_ptr<RValue>& value() const noexcept;
 };
 
 class ParamAtom : public Atom {
@@ -221,6 +352,10 @@ public:
 	std::string toString() const override;
 
 	void generate(std::ostream& stream, Translator *translator, int scope) const override;
+
+	std::vector<std::shared_ptr<RValue>> uses() const override;
+
+	const std::shared_ptr<RValue>& value() const noexcept;
 };
 
 #endif //PROJECT_MICRIC2_ATOMS_H
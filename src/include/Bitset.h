@@ -0,0 +1,44 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_BITSET_H
+#define PROJECT_MICRIC2_BITSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Bitset {
+private:
+	std::vector<uint64_t> _words;
+	size_t _size = 0;
+
+public:
+	Bitset() = default;
+
+	explicit Bitset(size_t size, bool value = false);
+
+	size_t size() const;
+
+	bool test(size_t index) const;
+
+	void set(size_t index);
+
+	void reset(size_t index);
+
+	size_t count() const;
+
+	// the operations below return whether this set has changed
+	bool unite(const Bitset& other);
+
+	bool intersect(const Bitset& other);
+
+	bool subtract(const Bitset& other);
+
+	bool operator==(const Bitset& rhs) const;
+
+	bool operator!=(const Bitset& rhs) const;
+};
+
+#endif //PROJECT_MICRIC2_BITSET_H
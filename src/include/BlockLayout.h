@@ -0,0 +1,29 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_BLOCKLAYOUT_H
+#define PROJECT_MICRIC2_BLOCKLAYOUT_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+
+class Translator;
+
+// profile-guided order of the blocks of a function: the hottest successor of a block follows it,
+// blocks the profile never reached go to the end
+class BlockLayout {
+private:
+	Translator& _translator;
+	// executions of the atoms by their index in the function
+	const std::map<int, size_t>& _hits;
+
+public:
+	BlockLayout(Translator& translator, const std::map<int, size_t>& hits);
+
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_BLOCKLAYOUT_H
@@ -0,0 +1,19 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_BRANCHFUSION_H
+#define PROJECT_MICRIC2_BRANCHFUSION_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+
+class BranchFusion {
+public:
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+	bool materialize(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_BRANCHFUSION_H
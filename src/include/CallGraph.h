@@ -0,0 +1,32 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_CALLGRAPH_H
+#define PROJECT_MICRIC2_CALLGRAPH_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include "Atoms.h"
+#include "SymbolTable.h"
+
+class CallGraph {
+private:
+	std::map<Scope, std::set<Scope>> _callees;
+	std::set<Scope> _empty;
+
+public:
+	explicit CallGraph(const std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms);
+
+	const std::set<Scope>& callees(Scope function) const;
+
+	bool reaches(Scope from, Scope to) const;
+
+	std::set<Scope> reachable(Scope root) const;
+
+	std::vector<Scope> postorder() const;
+};
+
+#endif //PROJECT_MICRIC2_CALLGRAPH_H
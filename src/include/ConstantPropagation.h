@@ -0,0 +1,64 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_CONSTANTPROPAGATION_H
+#define PROJECT_MICRIC2_CONSTANTPROPAGATION_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "ControlFlowGraph.h"
+#include "SideEffects.h"
+#include "SymbolTable.h"
+
+class ConstantPropagation {
+public:
+	struct LatticeValue {
+		enum class Kind {
+			undefined, constant, overdefined
+		};
+
+		Kind _kind = Kind::undefined;
+		int _value = 0;
+
+		bool operator==(const LatticeValue& rhs) const;
+
+		bool operator!=(const LatticeValue& rhs) const;
+	};
+
+	typedef std::vector<LatticeValue> State;
+
+private:
+	const SymbolTable& _symbolTable;
+	const SideEffects& _sideEffects;
+	State _entryState;
+
+	LatticeValue evaluate(const std::shared_ptr<RValue>& operand, const State& state) const;
+
+	void transfer(const std::shared_ptr<Atom>& atom, State& state) const;
+
+	int branchOutcome(const std::shared_ptr<ConditionalJumpAtom>& atom, const State& state) const;
+
+	std::shared_ptr<RValue> substitute(const std::shared_ptr<RValue>& operand, const State& state,
+	                                   const std::map<size_t, std::shared_ptr<MemoryOperand>>& copies) const;
+
+	std::shared_ptr<Atom> rewrite(const std::shared_ptr<Atom>& atom, const State& state,
+	                              const std::map<size_t, std::shared_ptr<MemoryOperand>>& copies) const;
+
+	static bool meet(State& target, const State& source);
+
+public:
+	ConstantPropagation(const SymbolTable& symbolTable,
+	                    const std::map<Scope, std::vector<std::shared_ptr<Atom>>>& program,
+	                    const SideEffects& sideEffects);
+
+	static int normalize(int value);
+
+	static bool compare(const std::string& condition, int left, int right);
+
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms, const std::map<size_t, int>& parameters = {}) const;
+};
+
+#endif //PROJECT_MICRIC2_CONSTANTPROPAGATION_H
@@ -0,0 +1,54 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_CONTROLFLOWGRAPH_H
+#define PROJECT_MICRIC2_CONTROLFLOWGRAPH_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+
+struct BasicBlock {
+	std::vector<std::shared_ptr<Atom>> atoms;
+	std::vector<size_t> successors;
+	std::vector<size_t> predecessors;
+};
+
+struct Loop {
+	size_t header;
+	std::vector<size_t> blocks;
+	std::vector<size_t> latches;
+};
+
+class ControlFlowGraph {
+private:
+	std::vector<BasicBlock> _blocks;
+	std::map<int, size_t> _labels;
+
+	void link(size_t from, size_t to);
+
+public:
+	explicit ControlFlowGraph(const std::vector<std::shared_ptr<Atom>>& atoms);
+
+	size_t size() const;
+
+	BasicBlock& operator[](size_t index);
+
+	const BasicBlock& operator[](size_t index) const;
+
+	int64_t findLabel(int labelId) const;
+
+	std::vector<size_t> reversePostorder() const;
+
+	std::vector<std::vector<bool>> dominators() const;
+
+	std::vector<Loop> loops() const;
+
+	bool hasPreheaderSlot(const Loop& loop) const;
+
+	std::vector<std::shared_ptr<Atom>> atoms() const;
+};
+
+#endif //PROJECT_MICRIC2_CONTROLFLOWGRAPH_H
@@ -0,0 +1,46 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_DATAFLOW_H
+#define PROJECT_MICRIC2_DATAFLOW_H
+
+#include <vector>
+#include "Bitset.h"
+#include "ControlFlowGraph.h"
+
+// gen/kill problem over the basic blocks, solved to the fixpoint by a worklist
+class Dataflow {
+public:
+	enum class Direction {
+		forward, backward
+	};
+
+	enum class Meet {
+		unite, intersect
+	};
+
+	struct Problem {
+		Direction direction = Direction::forward;
+		Meet meet = Meet::unite;
+		size_t width = 0;
+		// indexed by block
+		std::vector<Bitset> gen;
+		std::vector<Bitset> kill;
+		// value at the entry block for forward problems, at the exit blocks for backward ones
+		Bitset boundary;
+	};
+
+private:
+	std::vector<Bitset> _in;
+	std::vector<Bitset> _out;
+
+public:
+	Dataflow(const ControlFlowGraph& graph, const Problem& problem);
+
+	const Bitset& in(size_t block) const;
+
+	const Bitset& out(size_t block) const;
+};
+
+#endif //PROJECT_MICRIC2_DATAFLOW_H
@@ -0,0 +1,101 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_EMULATOR_H
+#define PROJECT_MICRIC2_EMULATOR_H
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// runs the emitted 8080 code: the text is assembled in process, IN 0 reads the next number of the
+// input, OUT 1 writes a number and the library helpers @MULT, @DIV and @PRINT are run natively
+class Emulator {
+public:
+	// the index of the source line and the T-states of every executed instruction
+	typedef std::function<void(size_t line, size_t cycles)> Tracer;
+
+private:
+	enum class Opcode {
+		MOV, MVI, LXI, LDA, STA, LHLD, SHLD, LDAX, STAX, XCHG, XTHL, SPHL, PCHL,
+		ADD, ADC, SUB, SBB, ANA, XRA, ORA, CMP, ADI, ACI, SUI, SBI, ANI, XRI, ORI, CPI,
+		INR, DCR, INX, DCX, DAD, RLC, RRC, RAL, RAR, CMA, CMC, STC,
+		JMP, JCC, CALL, CCC, RET, RCC, RST, PUSH, POP, IN, OUT, EI, DI, HLT, NOP, HELPER
+	};
+
+	struct Instruction {
+		Opcode opcode;
+		int first = 0;
+		int second = 0;
+		uint16_t value = 0;
+		std::string helper;
+		size_t line = 0;
+		size_t size = 0;
+		size_t cycles = 0;
+	};
+
+	std::vector<uint8_t> _memory;
+	std::vector<Instruction> _instructions;
+	std::vector<int> _instructionAt;
+	std::map<std::string, uint16_t> _labels;
+	// the address of the END directive, -1 if there is none
+	long _end = -1;
+
+	uint8_t _registers[8] = {};
+	bool _sign = false, _zero = false, _parity = false, _carry = false;
+	uint16_t _sp = 0;
+	uint16_t _pc = 0;
+	// bytes written by OUT to the ports other than 1
+	std::map<int, std::string> _ports;
+
+	uint16_t value(const std::string& operand, size_t line) const;
+
+	Instruction decode(const std::string& mnemonic, const std::vector<std::string>& operands, size_t line) const;
+
+	uint8_t get(int reg);
+
+	void set(int reg, uint8_t value);
+
+	uint16_t pair(int reg) const;
+
+	void setPair(int reg, uint16_t value);
+
+	void push(uint16_t value);
+
+	uint16_t pop();
+
+	void arithmetic(Opcode opcode, uint8_t operand);
+
+	bool condition(int code) const;
+
+	void helper(const std::string& name, std::ostream& output);
+
+public:
+	explicit Emulator(const std::string& code);
+
+	// runs from address 0 until the END directive is reached with an empty stack, throws after limit instructions
+	size_t run(std::istream& input, std::ostream& output, const Tracer& tracer = nullptr,
+	           size_t limit = 100000000);
+
+	uint16_t address(const std::string& label) const;
+
+	uint8_t memory(uint16_t address) const;
+
+	std::string portOutput(int port) const;
+};
+
+class EmulationException : public std::exception {
+private:
+	std::string _error;
+public:
+	EmulationException(std::string error);
+
+	const char *what() const noexcept override;
+};
+
+#endif //PROJECT_MICRIC2_EMULATOR_H
@@ -5,6 +5,8 @@
 #ifndef PROJECT_MICRIC2_GLOBALPARAMETERS_H
 #define PROJECT_MICRIC2_GLOBALPARAMETERS_H
 
+#include <string>
+
 class GlobalParameters {
 private:
 	GlobalParameters() = default;
@@ -12,6 +14,12 @@ private:
 public:
 	bool enableOperatorFormatter = false;
 	bool printAsmHeader = false;
+	int optimizationLevel = 0;
+	bool optimizeForSize = false;
+	bool byteFrames = false;
+	bool profileGenerate = false;
+	bool rstHelpers = false;
+	std::string target = "8080";
 
 	static GlobalParameters& getInstance();
 };
@@ -0,0 +1,39 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_INDUCTIONVARIABLES_H
+#define PROJECT_MICRIC2_INDUCTIONVARIABLES_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "ControlFlowGraph.h"
+#include "SymbolTable.h"
+
+class InductionVariables {
+public:
+	struct Variable {
+		size_t index;
+		// temp holding the stepped value before it is copied into the variable, -1 if none
+		int64_t alias;
+		int step;
+		size_t block;
+		size_t position;
+	};
+
+private:
+	SymbolTable& _symbolTable;
+	Scope _scope;
+
+	bool reduce(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+public:
+	InductionVariables(SymbolTable& symbolTable, Scope scope);
+
+	static std::vector<Variable> find(const ControlFlowGraph& graph, const Loop& loop, const SymbolTable& symbolTable);
+
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_INDUCTIONVARIABLES_H
@@ -0,0 +1,38 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_INLINER_H
+#define PROJECT_MICRIC2_INLINER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "CallGraph.h"
+#include "SymbolTable.h"
+
+class Translator;
+
+class Inliner {
+private:
+	std::map<Scope, std::vector<std::shared_ptr<Atom>>>& _atoms;
+	SymbolTable& _symbolTable;
+	Translator& _translator;
+	size_t _budget;
+
+	std::vector<std::shared_ptr<Atom>> expand(Scope caller, const std::shared_ptr<CallAtom>& call,
+	                                          const std::vector<std::shared_ptr<Atom>>& params);
+
+	bool inlineCalls(Scope caller, const CallGraph& graph);
+
+public:
+	Inliner(std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms, SymbolTable& symbolTable,
+	        Translator& translator, size_t budget);
+
+	static size_t cost(const std::vector<std::shared_ptr<Atom>>& atoms);
+
+	bool run();
+};
+
+#endif //PROJECT_MICRIC2_INLINER_H
@@ -0,0 +1,56 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_INTERPROCEDURALCONSTANTS_H
+#define PROJECT_MICRIC2_INTERPROCEDURALCONSTANTS_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+#include "Atoms.h"
+#include "SymbolTable.h"
+
+class Translator;
+
+class InterproceduralConstants {
+public:
+	typedef std::map<size_t, int> Parameters;
+
+private:
+	struct CallSite {
+		Scope caller;
+		size_t position;
+		// normalized constant arguments, -1 for the others
+		std::vector<int> arguments;
+		bool inLoop;
+	};
+
+	std::map<Scope, std::vector<std::shared_ptr<Atom>>>& _atoms;
+	SymbolTable& _symbolTable;
+	Translator& _translator;
+	size_t _budget;
+	bool _specialized = false;
+	std::map<Scope, Parameters> _parameters;
+	std::map<Scope, size_t> _clones;
+	Parameters _none;
+
+	std::vector<size_t> parameterRecords(Scope function) const;
+
+	std::map<Scope, std::vector<CallSite>> callSites() const;
+
+	std::shared_ptr<MemoryOperand> clone(Scope function);
+
+	std::set<Scope> specialize(const std::map<Scope, std::vector<CallSite>>& sites);
+
+public:
+	InterproceduralConstants(std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms, SymbolTable& symbolTable,
+	                         Translator& translator, size_t budget);
+
+	std::set<Scope> run();
+
+	const Parameters& parameters(Scope function) const;
+};
+
+#endif //PROJECT_MICRIC2_INTERPROCEDURALCONSTANTS_H
@@ -0,0 +1,37 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_JUMPTHREADING_H
+#define PROJECT_MICRIC2_JUMPTHREADING_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+
+class JumpThreading {
+private:
+	static std::shared_ptr<LabelOperand> target(const std::shared_ptr<Atom>& atom);
+
+	static std::shared_ptr<Atom> retarget(const std::shared_ptr<Atom>& atom, const std::shared_ptr<LabelOperand>& label);
+
+	static int labelOf(const std::shared_ptr<Atom>& atom);
+
+	bool mergeLabels(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+	bool threadJumps(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+	bool removeFallthroughJumps(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+	bool invertJumpsOverJumps(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+	bool removeDeadCode(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+	bool removeUnusedLabels(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+public:
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_JUMPTHREADING_H
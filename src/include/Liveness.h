@@ -0,0 +1,39 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_LIVENESS_H
+#define PROJECT_MICRIC2_LIVENESS_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "Bitset.h"
+#include "ControlFlowGraph.h"
+#include "Dataflow.h"
+#include "SymbolTable.h"
+
+// live variables, one bit per symbol table record
+class Liveness {
+private:
+	Bitset _globals;
+	std::vector<Bitset> _blockIn;
+	std::vector<Bitset> _blockOut;
+	// live before each atom
+	std::vector<std::vector<Bitset>> _atomIn;
+
+	void transfer(const std::shared_ptr<Atom>& atom, Bitset& live) const;
+
+public:
+	Liveness(const SymbolTable& symbolTable, const ControlFlowGraph& graph);
+
+	const Bitset& liveIn(size_t block) const;
+
+	const Bitset& liveOut(size_t block) const;
+
+	const Bitset& liveIn(size_t block, size_t atom) const;
+
+	const Bitset& liveOut(size_t block, size_t atom) const;
+};
+
+#endif //PROJECT_MICRIC2_LIVENESS_H
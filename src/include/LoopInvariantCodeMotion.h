@@ -0,0 +1,38 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_LOOPINVARIANTCODEMOTION_H
+#define PROJECT_MICRIC2_LOOPINVARIANTCODEMOTION_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "ControlFlowGraph.h"
+#include "SideEffects.h"
+#include "SymbolTable.h"
+
+class LoopInvariantCodeMotion {
+private:
+	typedef std::pair<size_t, size_t> Position;
+
+	const SymbolTable& _symbolTable;
+	const SideEffects& _sideEffects;
+	std::map<int, size_t>& _hoisted;
+
+	bool isGlobal(const std::shared_ptr<MemoryOperand>& operand) const;
+
+	std::vector<Position> findInvariants(const ControlFlowGraph& graph, const std::vector<std::vector<bool>>& dominators,
+	                                     const Loop& loop) const;
+
+	bool hoist(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+public:
+	LoopInvariantCodeMotion(const SymbolTable& symbolTable, const SideEffects& sideEffects,
+	                        std::map<int, size_t>& hoisted);
+
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_LOOPINVARIANTCODEMOTION_H
@@ -0,0 +1,34 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_LOOPUNROLLING_H
+#define PROJECT_MICRIC2_LOOPUNROLLING_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "ControlFlowGraph.h"
+#include "SymbolTable.h"
+
+class Translator;
+
+class LoopUnrolling {
+private:
+	const SymbolTable& _symbolTable;
+	Translator& _translator;
+	size_t _budget;
+
+	static bool entryValue(const ControlFlowGraph& graph, const Loop& loop, size_t index, int& value);
+
+	int64_t tripCount(const ControlFlowGraph& graph, const Loop& loop) const;
+
+	bool unroll(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+public:
+	LoopUnrolling(const SymbolTable& symbolTable, Translator& translator, size_t budget);
+
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_LOOPUNROLLING_H
@@ -0,0 +1,34 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_OPTIMIZER_H
+#define PROJECT_MICRIC2_OPTIMIZER_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "SymbolTable.h"
+
+class Translator;
+
+class Optimizer {
+private:
+	std::map<Scope, std::vector<std::shared_ptr<Atom>>>& _atoms;
+	SymbolTable& _symbolTable;
+	Translator& _translator;
+	std::map<Scope, std::map<int, size_t>> _hoistedAtoms;
+
+	void normalizeParams(std::vector<std::shared_ptr<Atom>>& atoms) const;
+
+public:
+	Optimizer(std::map<Scope, std::vector<std::shared_ptr<Atom>>>& atoms, SymbolTable& symbolTable,
+	          Translator& translator);
+
+	void run();
+
+	const std::map<Scope, std::map<int, size_t>>& hoistedAtoms() const;
+};
+
+#endif //PROJECT_MICRIC2_OPTIMIZER_H
@@ -0,0 +1,48 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_PEEPHOLE_H
+#define PROJECT_MICRIC2_PEEPHOLE_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// rewrites short windows of the emitted 8080 code, comment lines are skipped over
+class Peephole {
+public:
+	struct Instruction {
+		std::string label;
+		std::string mnemonic;
+		std::vector<std::string> operands;
+		std::string text;
+
+		bool is(const std::string& mnemonic, const std::vector<std::string>& operands = {}) const;
+	};
+
+	struct Rule {
+		std::string name;
+		size_t window;
+		std::function<bool(const std::vector<Instruction>&)> matches;
+		// the new text of every instruction of the window, an empty string removes it
+		std::function<std::vector<std::string>(const std::vector<Instruction>&)> rewrite;
+	};
+
+private:
+	std::vector<size_t> _hits;
+
+public:
+	Peephole();
+
+	static const std::vector<Rule>& rules();
+
+	static Instruction parse(const std::string& line);
+
+	std::string run(const std::string& code);
+
+	std::vector<std::pair<std::string, size_t>> hits() const;
+};
+
+#endif //PROJECT_MICRIC2_PEEPHOLE_H
@@ -0,0 +1,62 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_PROFILER_H
+#define PROJECT_MICRIC2_PROFILER_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Translator.h"
+
+// runs the generated code in the emulator and attributes its cycles to functions, source lines and atoms
+class Profiler {
+public:
+	struct Edge {
+		size_t calls = 0;
+		size_t cycles = 0;
+	};
+
+private:
+	std::vector<Translator::ListingLine> _listing;
+	size_t _cycles = 0;
+	std::map<std::string, size_t> _selfCycles;
+	std::map<std::string, size_t> _totalCycles;
+	std::map<std::string, size_t> _calls;
+	std::map<std::pair<std::string, size_t>, size_t> _lineCycles;
+	std::map<std::pair<std::string, std::string>, Edge> _edges;
+	// keyed by the function and the atom index
+	std::map<std::pair<std::string, int>, size_t> _atomHits;
+	std::map<std::string, size_t> _stacks;
+	std::string _counterDump;
+
+public:
+	explicit Profiler(std::vector<Translator::ListingLine> listing);
+
+	// IN 0 reads the numbers of input, the program writes to output
+	void run(std::istream& input, std::ostream& output, size_t limit = 100000000);
+
+	size_t cycles() const;
+
+	const std::map<std::pair<std::string, int>, size_t>& atomHits() const;
+
+	// the counters an instrumented build wrote to port 2
+	const std::string& counterDump() const;
+
+	// the atom hits of a profile written by printProfile or printCounterProfile
+	static std::map<std::pair<std::string, int>, size_t> readAtomHits(std::istream& stream);
+
+	// turns the counter dump of an instrumented build into a profile, false if the dump is too short
+	static bool printCounterProfile(std::ostream& stream, const std::vector<Translator::ProfileCounter>& counters,
+	                                std::istream& dump);
+
+	void printProfile(std::ostream& stream) const;
+
+	// the collapsed stack format of the flamegraph scripts, "main;f;g cycles" per stack
+	void printFoldedStacks(std::ostream& stream) const;
+};
+
+#endif //PROJECT_MICRIC2_PROFILER_H
@@ -0,0 +1,25 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_REDUNDANTCALLS_H
+#define PROJECT_MICRIC2_REDUNDANTCALLS_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "SideEffects.h"
+#include "SymbolTable.h"
+
+class RedundantCalls {
+private:
+	const SymbolTable& _symbolTable;
+	const SideEffects& _sideEffects;
+
+public:
+	RedundantCalls(const SymbolTable& symbolTable, const SideEffects& sideEffects);
+
+	bool run(std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_REDUNDANTCALLS_H
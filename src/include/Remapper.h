@@ -0,0 +1,33 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_REMAPPER_H
+#define PROJECT_MICRIC2_REMAPPER_H
+
+#include <map>
+#include <memory>
+#include "Atoms.h"
+
+class Remapper {
+public:
+	typedef std::map<size_t, std::shared_ptr<MemoryOperand>> Variables;
+	typedef std::map<int, std::shared_ptr<LabelOperand>> Labels;
+
+	static std::shared_ptr<MemoryOperand> rename(const std::shared_ptr<MemoryOperand>& memory,
+	                                             const Variables& variables);
+
+	static std::shared_ptr<RValue> rename(const std::shared_ptr<RValue>& operand, const Variables& variables);
+
+	static std::shared_ptr<LabelOperand> rename(const std::shared_ptr<LabelOperand>& label, const Labels& labels);
+
+	// the copy keeps the source line of the atom
+	static std::shared_ptr<Atom> remap(const std::shared_ptr<Atom>& atom, const Variables& variables,
+	                                   const Labels& labels);
+
+private:
+	static std::shared_ptr<Atom> copy(const std::shared_ptr<Atom>& atom, const Variables& variables,
+	                                  const Labels& labels);
+};
+
+#endif //PROJECT_MICRIC2_REMAPPER_H
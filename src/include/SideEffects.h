@@ -0,0 +1,47 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_SIDEEFFECTS_H
+#define PROJECT_MICRIC2_SIDEEFFECTS_H
+
+#include <map>
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "SymbolTable.h"
+
+class SideEffects {
+public:
+	struct Summary {
+		bool readsGlobals = true;
+		bool writesGlobals = true;
+		bool io = true;
+
+		// the result depends on the arguments only
+		bool isPure() const;
+
+		// nothing outside the frame changes, the result may depend on globals
+		bool isReadOnly() const;
+
+		bool operator==(const Summary& rhs) const;
+
+		bool operator!=(const Summary& rhs) const;
+	};
+
+private:
+	std::map<Scope, Summary> _summaries;
+	Summary _unknown;
+
+public:
+	SideEffects() = default;
+
+	SideEffects(const SymbolTable& symbolTable, const std::map<Scope, std::vector<std::shared_ptr<Atom>>>& program);
+
+	const Summary& operator[](Scope function) const;
+
+	// effects of a CALL or TAILCALL atom
+	const Summary& of(const std::shared_ptr<Atom>& call) const;
+};
+
+#endif //PROJECT_MICRIC2_SIDEEFFECTS_H
@@ -0,0 +1,24 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_STACKSLOTS_H
+#define PROJECT_MICRIC2_STACKSLOTS_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "SymbolTable.h"
+
+class StackSlots {
+private:
+	SymbolTable& _symbolTable;
+
+public:
+	explicit StackSlots(SymbolTable& symbolTable);
+
+	// gives locals and temps with disjoint live ranges the same frame slot, returns the frame size
+	size_t run(Scope scope, const std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_STACKSLOTS_H
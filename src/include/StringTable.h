@@ -18,9 +18,11 @@ public:
 
 	std::shared_ptr<StringOperand> add(const std::string& name);
 
+	size_t size() const;
+
 	void printStringTable(std::ostream& stream);
 
-    void generateStrings(std::ostream& stream) const;
+    void generateStrings(std::ostream& stream, const std::vector<bool>& live = {}) const;
 };
 
 #endif //PROJECT_MICRIC2_STRINGTABLE_H
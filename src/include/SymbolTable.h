@@ -6,6 +6,7 @@
 #define PROJECT_MICRIC2_SYMBOLTABLE_H
 
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -33,6 +34,8 @@ public:
 		int _init = 0;
 		Scope _scope = GLOBAL_SCOPE;
 		int _offset = -1;
+		// frame slot shared with other locals, -1 if the frame was not colored
+		int _slot = -1;
 
 
 		bool operator==(const TableRecord& rhs) const;
@@ -43,6 +46,8 @@ public:
 private:
 	int lastTemp = 0;
 
+	std::map<Scope, size_t> _frameSlots;
+
 public:
     std::vector<TableRecord> _records;
 
@@ -52,11 +57,23 @@ public:
 
     size_t getM(Scope scope) const;
 
+	size_t getLocalCount(Scope scope) const;
+
+	// bytes taken by the locals and temps, a slot is one byte with byte frames and two otherwise
+	size_t getFrameSize(Scope scope) const;
+
+	static size_t getSlotSize();
+
+	// locals and temps of the scope with a slot of -1 take no space in the frame
+	void setFrameSlots(Scope scope, size_t count);
+
+	bool hasColoredFrame(Scope scope) const;
+
     void calculateOffset();
 
     std::vector<std::pair<std::string, int>> functionNames() const;
 
-    void generateGlobals(std::ostream& stream) const;
+    void generateGlobals(std::ostream& stream, const std::vector<bool>& live = {}) const;
 
 	std::shared_ptr<MemoryOperand> addVar(const std::string& name,
 	                                      const Scope scope, TableRecord::RecordType type,
@@ -0,0 +1,32 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_TAILCALLS_H
+#define PROJECT_MICRIC2_TAILCALLS_H
+
+#include <memory>
+#include <vector>
+#include "Atoms.h"
+#include "SymbolTable.h"
+
+class Translator;
+
+class TailCalls {
+private:
+	SymbolTable& _symbolTable;
+	Translator& _translator;
+
+	static bool isReturned(const std::vector<std::shared_ptr<Atom>>& atoms, size_t call);
+
+	static bool hasArguments(const std::vector<std::shared_ptr<Atom>>& atoms, int n);
+
+public:
+	TailCalls(SymbolTable& symbolTable, Translator& translator);
+
+	bool eliminateRecursion(Scope scope, std::vector<std::shared_ptr<Atom>>& atoms);
+
+	bool reuseFrames(Scope scope, std::vector<std::shared_ptr<Atom>>& atoms) const;
+};
+
+#endif //PROJECT_MICRIC2_TAILCALLS_H
@@ -0,0 +1,73 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#ifndef PROJECT_MICRIC2_TARGET_H
+#define PROJECT_MICRIC2_TARGET_H
+
+#include <iostream>
+#include <string>
+
+// the processor the code is emitted for: the atoms generate 8080 code, which the peephole, the layout
+// and the emulator work on, and the target lowers it to its own instructions at the end
+class Target {
+public:
+	virtual ~Target() = default;
+
+	virtual std::string name() const = 0;
+
+	// the runtime library behind the prolog, in 8080 code and the instructions of the target that 8080 has not
+	virtual void generateHelpers(std::ostream& stream) const = 0;
+
+	// the header: the globals, the prolog and the helpers
+	virtual std::string lowerHeader(const std::string& code) const = 0;
+
+	// the code of one function from its label on
+	virtual std::string lowerFunction(const std::string& code) const = 0;
+
+	// one line of the lowered code, labels and comments take no space
+	virtual size_t instructionSize(const std::string& line) const = 0;
+
+	// T-states, a conditional jump, CALL or RET is counted as taken
+	virtual size_t instructionCycles(const std::string& line) const = 0;
+
+	// nullptr for an unknown name
+	static const Target *get(const std::string& name);
+
+	// the target of GlobalParameters
+	static const Target& current();
+};
+
+class Intel8080Target : public Target {
+public:
+	std::string name() const override;
+
+	void generateHelpers(std::ostream& stream) const override;
+
+	std::string lowerHeader(const std::string& code) const override;
+
+	std::string lowerFunction(const std::string& code) const override;
+
+	size_t instructionSize(const std::string& line) const override;
+
+	size_t instructionCycles(const std::string& line) const override;
+};
+
+// Zilog mnemonics, frames addressed through IX, JR wherever the label is in reach and a @PRINT
+// built on CPIR and OTIR
+class Z80Target : public Target {
+public:
+	std::string name() const override;
+
+	void generateHelpers(std::ostream& stream) const override;
+
+	std::string lowerHeader(const std::string& code) const override;
+
+	std::string lowerFunction(const std::string& code) const override;
+
+	size_t instructionSize(const std::string& line) const override;
+
+	size_t instructionCycles(const std::string& line) const override;
+};
+
+#endif //PROJECT_MICRIC2_TARGET_H
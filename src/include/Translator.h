@@ -5,14 +5,34 @@
 #define PROJECT_MICRIC2_TRANSLATOR_H
 
 #include "Atoms.h"
+#include "Peephole.h"
 #include "StringTable.h"
 #include "SymbolTable.h"
 #include "Scanner.h"
 #include <exception>
 #include <queue>
+#include <set>
 #include <iostream>
 
 class Translator {
+public:
+	// a line of the generated code and the function, atom and source line it was generated for
+	struct ListingLine {
+		std::string text;
+		Scope scope;
+		std::string function;
+		int atom;
+		std::string atomText;
+		size_t row;
+	};
+
+	// a counter of the instrumented code, the hits of a block starting at the atom or the calls to the callee
+	struct ProfileCounter {
+		std::string function;
+		int atom;
+		std::string callee;
+	};
+
 protected:
 	std::map<Scope, std::vector<std::shared_ptr<Atom>>> _atoms;
 	SymbolTable _symbolTable;
@@ -23,19 +43,56 @@ protected:
 	std::deque<Token> _lastLexemes;
 
 	size_t _labelCount;
+
+	std::map<Scope, std::map<int, size_t>> _hoistedAtoms;
+
+	std::set<Scope> _unreachableFunctions;
+	std::vector<bool> _liveRecords;
+	std::vector<bool> _liveStrings;
+	size_t _removedBytes = 0;
+
+	Peephole _peephole;
+
+	std::map<Scope, std::string> _functionCode;
+	std::string _headerCode;
+	std::vector<std::pair<std::string, int>> _emittedFunctions;
+
+	// atom hits by function name and atom index, empty without a profile
+	std::map<std::pair<std::string, int>, size_t> _profile;
+
+	std::vector<ProfileCounter> _counters;
+	// the counters incremented before the code of an atom, by the atom index
+	std::map<Scope, std::multimap<int, size_t>> _counterAtoms;
+
+	// the RST vector of a runtime helper
+	std::map<std::string, int> _helperVectors;
 public:
 	std::vector<std::shared_ptr<RValue>> codeGenFuncArgs;
 
+	std::map<int, int> codeGenSkipLabels;
+
+	size_t codeGenSwitchCount = 0;
+
 	Translator(std::istream& inputStream);
 
 	virtual void startTranslation();
 
-	static void generateProlog(std::ostream& stream);
+	void optimize();
+
+	// lays the blocks and functions out by the hits of a profile taken from the same source and options
+	void setProfile(std::map<std::pair<std::string, int>, size_t> profile);
+
+	static void generateProlog(std::ostream& stream, const std::map<std::string, int>& helperVectors = {});
+
+	static void generateProfileDump(std::ostream& stream, size_t counters);
 
 	void generateFunction(std::ostream& stream, const std::pair<std::string, int>& par);
 
 	void generateCode(std::ostream& stream);
 
+	// a RST to the vector of the helper if it has one, a CALL otherwise
+	std::string callHelper(const std::string& helper) const;
+
 	const SymbolTable& getSymbolTable() const;
 
 	const StringTable& getStringTable() const;
@@ -46,6 +103,20 @@ public:
 
 	void printStringTable(std::ostream& stream);
 
+	void printOptimizationReport(std::ostream& stream);
+
+	// needs the code to be generated first
+	void printPerformanceReport(std::ostream& stream);
+
+	// function, source line and symbol addresses of the generated code, needs the code to be generated first
+	void generateMap(std::ostream& stream);
+
+	// the header is listed in the global scope and the prologue of a function with atom -1, needs the code to be generated first
+	std::vector<ListingLine> listing();
+
+	// the counters of an instrumented build in the order they are dumped, needs the code to be generated first
+	const std::vector<ProfileCounter>& counters() const;
+
 	void generateAtoms(Scope scope, const std::shared_ptr<Atom>& atom);
 
 	std::shared_ptr<LabelOperand> newLabel();
@@ -58,6 +129,23 @@ public:
 
 protected:
 
+	void pruneCallGraph();
+
+	void layoutBlocks();
+
+	size_t functionHits(const std::string& function) const;
+
+	void assignHelperVectors();
+
+	void allocateCounters(const std::vector<std::pair<std::string, int>>& functions);
+
+	std::string instrument(const std::pair<std::string, int>& function, size_t index, const std::string& code);
+
+	void reserveFrame(std::ostream& stream, Scope scope);
+
+	// the atom every line of the function code was generated by, -1 for the prologue
+	std::vector<int> lineAtoms(Scope scope, const std::string& code);
+
 	void getAndCheckLexeme(bool eofAcceptable = false, const std::vector<LexemType>& acceptableLexems = {});
 
 	std::shared_ptr<MemoryOperand> checkVar(const Scope scope, const std::string& name);
@@ -94,6 +182,18 @@ protected:
 
 	std::shared_ptr<RValue> E7_(Scope scope, std::shared_ptr<RValue> p);
 
+	bool CondE7(Scope scope, const std::shared_ptr<LabelOperand>& falseLabel);
+
+	std::shared_ptr<LabelOperand> CondE6(Scope scope, const std::shared_ptr<LabelOperand>& trueLabel);
+
+	bool CondE5(Scope scope, const std::shared_ptr<LabelOperand>& falseLabel);
+
+	void invertLastJump(Scope scope, const std::shared_ptr<LabelOperand>& label);
+
+	void retargetCondition(Scope scope, size_t start, const std::shared_ptr<LabelOperand>& skip,
+	                       const std::shared_ptr<LabelOperand>& trueLabel,
+	                       const std::shared_ptr<LabelOperand>& falseLabel);
+
 	int ArgList(Scope scope);
 
 	int ArgList_(Scope scope);
@@ -138,6 +238,11 @@ protected:
 
 	std::shared_ptr<RValue> ForExp(Scope scope);
 
+	bool ForCondition(Scope scope, const std::shared_ptr<LabelOperand>& falseLabel);
+
+	void generateLoopTest(Scope scope, const std::vector<std::shared_ptr<Atom>>& condition,
+	                      const std::shared_ptr<LabelOperand>& exit, const std::shared_ptr<LabelOperand>& top);
+
 	bool ForLoop(Scope scope);
 
 	bool ElsePart(Scope scope);
@@ -150,6 +255,9 @@ protected:
 	std::shared_ptr<LabelOperand>
 	ACase(Scope scope, const std::shared_ptr<RValue>& p, const std::shared_ptr<LabelOperand>& end);
 
+	bool SwitchCases(Scope scope, SwitchAtom::Cases& cases, std::shared_ptr<LabelOperand>& def,
+	                 const std::shared_ptr<LabelOperand>& end);
+
 	bool OOp_(Scope scope);
 
 };
@@ -2,6 +2,9 @@
 #include <sstream>
 #include <fstream>
 #include <GlobalParameters.h>
+#include "Emulator.h"
+#include "Profiler.h"
+#include "Target.h"
 #include "Translator.h"
 
 std::string getFullFilename(std::string string) {
@@ -38,10 +41,36 @@ int main(int argc, char **argv) {
 		          << '\t' << "-i file" << '\t' << "Set target file" << std::endl
 		          << '\t' << "-o file" << '\t' << "Set output file" << std::endl
 		          << '\t' << "-a" << '\t' << "Print atoms info (output will be .atom, not .asm)" << std::endl
-		          << '\t' << "-f" << '\t' << "Enable operator formatter (disabled by default)" << std::endl;
+		          << '\t' << "-f" << '\t' << "Enable operator formatter (disabled by default)" << std::endl
+		          << '\t' << "-O0" << '\t' << "Disable optimizations (default)" << std::endl
+		          << '\t' << "-O1" << '\t' << "Enable optimizations" << std::endl
+		          << '\t' << "-O2" << '\t' << "Enable optimizations and loop unrolling" << std::endl
+		          << '\t' << "-Os" << '\t' << "Enable optimizations that do not grow the code" << std::endl
+		          << '\t' << "-b" << '\t' << "Pack locals into bytes, reserve frames with SPHL" << std::endl
+		          << '\t' << "--report" << '\t' << "Print code size, frame size and cycle estimates per function"
+		          << std::endl
+		          << '\t' << "--map" << '\t' << "Write function, source line and symbol addresses to the output .map"
+		          << std::endl
+		          << '\t' << "--profile file" << '\t' << "Run the code in the emulator with IN 0 read from file, "
+		          << "write the profile to the output .prof and the folded stacks to the output .folded" << std::endl
+		          << '\t' << "--profile-use file" << '\t' << "Lay blocks and functions out by a .prof of the same "
+		          << "source and options, hot paths fall through and cold blocks go last" << std::endl
+		          << '\t' << "--profile-generate" << '\t' << "Count block entries and calls in 16-bit counters, "
+		          << "main dumps them to port 2 before it returns" << std::endl
+		          << '\t' << "--profile-dump file" << '\t' << "With --profile-generate, turn a counter dump into "
+		          << "the output .prof for --profile-use" << std::endl
+		          << '\t' << "--rst" << '\t' << "Call the runtime helpers with two or more call sites through RST "
+		          << "vectors, hottest first with --profile-use" << std::endl
+		          << '\t' << "--target name" << '\t' << "Emit code for 8080 (default) or z80: IX-based frames, "
+		          << "relative jumps and a @PRINT on block instructions" << std::endl;
 		return 1;
 	}
 	bool printAtoms = false;
+	bool printReport = false;
+	bool printMap = false;
+	std::string profileInput;
+	std::string profileUse;
+	std::string profileDump;
 	while (i < argc) {
 		input = std::string(argv[i]);
 		if (input == "-i") {
@@ -61,6 +90,61 @@ int main(int argc, char **argv) {
 		} else if (input == "-f") {
 			GlobalParameters::getInstance().enableOperatorFormatter = true;
 			++i;
+		} else if (input == "-O0" || input == "-O1" || input == "-O2") {
+			GlobalParameters::getInstance().optimizationLevel = input[2] - '0';
+			GlobalParameters::getInstance().optimizeForSize = false;
+			++i;
+		} else if (input == "-Os") {
+			GlobalParameters::getInstance().optimizationLevel = 2;
+			GlobalParameters::getInstance().optimizeForSize = true;
+			++i;
+		} else if (input == "-b") {
+			GlobalParameters::getInstance().byteFrames = true;
+			++i;
+		} else if (input == "--report") {
+			printReport = true;
+			++i;
+		} else if (input == "--profile") {
+			if (argc <= i + 1) {
+				std::cerr << "Empty --profile" << std::endl;
+				return 1;
+			}
+			profileInput = argv[i + 1];
+			i += 2;
+		} else if (input == "--profile-use") {
+			if (argc <= i + 1) {
+				std::cerr << "Empty --profile-use" << std::endl;
+				return 1;
+			}
+			profileUse = argv[i + 1];
+			i += 2;
+		} else if (input == "--profile-generate") {
+			GlobalParameters::getInstance().profileGenerate = true;
+			++i;
+		} else if (input == "--profile-dump") {
+			if (argc <= i + 1) {
+				std::cerr << "Empty --profile-dump" << std::endl;
+				return 1;
+			}
+			profileDump = argv[i + 1];
+			i += 2;
+		} else if (input == "--rst") {
+			GlobalParameters::getInstance().rstHelpers = true;
+			++i;
+		} else if (input == "--target") {
+			if (argc <= i + 1) {
+				std::cerr << "Empty --target" << std::endl;
+				return 1;
+			}
+			if (!Target::get(argv[i + 1])) {
+				std::cerr << "Unknown target " << argv[i + 1] << std::endl;
+				return 1;
+			}
+			GlobalParameters::getInstance().target = argv[i + 1];
+			i += 2;
+		} else if (input == "--map") {
+			printMap = true;
+			++i;
 		} else if (input == "-a") {
 			printAtoms = true;
 			GlobalParameters::getInstance().printAsmHeader = true;
@@ -71,6 +155,10 @@ int main(int argc, char **argv) {
 			++i;
 		}
 	}
+	if (!profileInput.empty() && GlobalParameters::getInstance().target != "8080") {
+		std::cerr << "The emulator of --profile runs 8080 code only" << std::endl;
+		return 1;
+	}
 	ifile.open(filename);
 	if (!ifile) {
 		std::cerr << "Failed to open input file" << std::endl;
@@ -92,9 +180,20 @@ int main(int argc, char **argv) {
 		return 1;
 	}
 	Translator translator(ifile);
+	if (!profileUse.empty()) {
+		std::ifstream profileFile(profileUse);
+		if (!profileFile) {
+			std::cerr << "Failed to open profile" << std::endl;
+			return 1;
+		}
+		translator.setProfile(Profiler::readAtomHits(profileFile));
+	}
 	try {
 		translator.startTranslation();
 		ifile.close();
+		// the code is generated first, the report includes the peephole counters
+		std::ostringstream code;
+		translator.generateCode(code);
 		if (printAtoms) {
 			translator.printAtoms(ofile);
 			ofile << std::endl;
@@ -102,9 +201,57 @@ int main(int argc, char **argv) {
 			ofile << std::endl;
 			translator.printStringTable(ofile);
 			ofile << std::endl;
+			if (GlobalParameters::getInstance().optimizationLevel > 0) {
+				translator.printOptimizationReport(ofile);
+				ofile << std::endl;
+			}
 		}
-		translator.generateCode(ofile);
+		ofile << code.str();
 		ofile.close();
+		if (printMap) {
+			std::string mapName = (output.empty() ? filename + extension : output) + ".map";
+			std::ofstream map(mapName);
+			if (!map) {
+				std::cerr << "Failed to create map file" << std::endl;
+				return 1;
+			}
+			translator.generateMap(map);
+			std::cout << "Written map: " << mapName << std::endl;
+		}
+		if (printReport) translator.printPerformanceReport(std::cout);
+		if (!profileDump.empty()) {
+			std::ifstream dump(profileDump, std::ios::binary);
+			std::string base = output.empty() ? filename + extension : output;
+			std::ofstream profile(base + ".prof");
+			if (!dump || !Profiler::printCounterProfile(profile, translator.counters(), dump)) {
+				std::cerr << "Failed to read the counter dump" << std::endl;
+				return 1;
+			}
+			std::cout << "Written profile: " << base + ".prof" << std::endl;
+		}
+		if (!profileInput.empty()) {
+			std::ifstream profileFile(profileInput);
+			if (!profileFile) {
+				std::cerr << "Failed to open profile input" << std::endl;
+				return 1;
+			}
+			std::string base = output.empty() ? filename + extension : output;
+			std::ofstream profile(base + ".prof");
+			std::ofstream folded(base + ".folded");
+			Profiler profiler(translator.listing());
+			profiler.run(profileFile, std::cout);
+			profiler.printProfile(profile);
+			profiler.printFoldedStacks(folded);
+			if (!profiler.counterDump().empty()) {
+				std::ofstream dump(base + ".dump", std::ios::binary);
+				dump << profiler.counterDump();
+			}
+			std::cout << "Written profile: " << base + ".prof" << std::endl;
+		}
+	} catch (const EmulationException &exception) {
+		std::cerr << "Exception during profiling:" << std::endl;
+		std::cerr << exception.what();
+		return 3;
 	} catch (TranslationException exception) {
 		std::cerr << "Exception during compiling:" << std::endl;
 		std::cerr << exception.what();
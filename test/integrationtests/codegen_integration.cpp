@@ -5,13 +5,32 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <sstream>
 #include <utility>
 #include "../../src/include/Atoms.h"
+#include "../../src/include/Profiler.h"
+#include "../../src/include/Target.h"
 #include "../../src/include/Translator.h"
 #include "../tools.h"
 #include "../../src/include/GlobalParameters.h"
 
+// a global parameter set for the rest of a test, put back even when an ASSERT fails
+template<typename T>
+class ScopedParameter {
+private:
+	T& _parameter;
+	T _saved;
+public:
+	ScopedParameter(T& parameter, T value) : _parameter(parameter), _saved(parameter) {
+		_parameter = value;
+	}
+
+	~ScopedParameter() {
+		_parameter = _saved;
+	}
+};
+
 TEST(CodeGenTests, Integration1) {
 	GlobalParameters::getInstance().enableOperatorFormatter = false;
 	GlobalParameters::getInstance().printAsmHeader = true;
@@ -99,12 +118,25 @@ TEST(CodeGenTests, Integration1) {
 			"MOV M, A\n"
 			"\t; (LBL,,, 2)\n"
 			"LBL2:\n"
+			"\t; (MOV, `0`,, 7)\n"
+			"MVI A, 0\n"
+			"LXI H, 8\n"
+			"DAD SP\n"
+			"MOV M, A\n"
+			"\t; (EQ, 6, `0`, 3)\n"
+			"MVI A, 0\n"
+			"MOV B, A\n"
+			"LXI H, 10\n"
+			"DAD SP\n"
+			"MOV A, M\n"
+			"CMP B\n"
+			"JZ LBL3\n"
 			"\t; (MOV, `1`,, 8)\n"
 			"MVI A, 1\n"
 			"LXI H, 6\n"
 			"DAD SP\n"
 			"MOV M, A\n"
-			"\t; (LE, 2, 3, 3)\n"
+			"\t; (LE, 2, 3, 4)\n"
 			"LXI H, 18\n"
 			"DAD SP\n"
 			"MOV A, M\n"
@@ -113,27 +145,30 @@ TEST(CodeGenTests, Integration1) {
 			"DAD SP\n"
 			"MOV A, M\n"
 			"CMP B\n"
-			"JM LBL3\n"
-			"JZ LBL3\n"
+			"JM LBL4\n"
+			"JZ LBL4\n"
 			"\t; (MOV, `0`,, 8)\n"
 			"MVI A, 0\n"
 			"LXI H, 6\n"
 			"DAD SP\n"
 			"MOV M, A\n"
-			"\t; (LBL,,, 3)\n"
-			"LBL3:\n"
-			"\t; (AND, 6, 8, 7)\n"
-			"LXI H, 6\n"
-			"DAD SP\n"
-			"MOV A, M\n"
+			"\t; (LBL,,, 4)\n"
+			"LBL4:\n"
+			"\t; (EQ, 8, `0`, 3)\n"
+			"MVI A, 0\n"
 			"MOV B, A\n"
-			"LXI H, 10\n"
+			"LXI H, 6\n"
 			"DAD SP\n"
 			"MOV A, M\n"
-			"ANA B\n"
+			"CMP B\n"
+			"JZ LBL3\n"
+			"\t; (MOV, `1`,, 7)\n"
+			"MVI A, 1\n"
 			"LXI H, 8\n"
 			"DAD SP\n"
 			"MOV M, A\n"
+			"\t; (LBL,,, 3)\n"
+			"LBL3:\n"
 			"\t; (EQ, 7, `0`, 0)\n"
 			"MVI A, 0\n"
 			"MOV B, A\n"
@@ -263,13 +298,13 @@ TEST(CodeGenTests, Integration1) {
 			"LXI B, 0\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 22\n"
+			"LXI H, 20\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 22\n"
+			"LXI H, 20\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
@@ -278,8 +313,8 @@ TEST(CodeGenTests, Integration1) {
 			"POP B\n"
 			"POP B\n"
 			"POP B\n"
-			"MOV A, B\n"
-			"LXI H, 14\n"
+			"MOV A, C\n"
+			"LXI H, 12\n"
 			"DAD SP\n"
 			"MOV M, A\n"
 			"POP PSW\n"
@@ -294,13 +329,13 @@ TEST(CodeGenTests, Integration1) {
 			"LXI B, 0\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 22\n"
+			"LXI H, 20\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 22\n"
+			"LXI H, 20\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
@@ -309,8 +344,8 @@ TEST(CodeGenTests, Integration1) {
 			"POP B\n"
 			"POP B\n"
 			"POP B\n"
-			"MOV A, B\n"
-			"LXI H, 10\n"
+			"MOV A, C\n"
+			"LXI H, 8\n"
 			"DAD SP\n"
 			"MOV M, A\n"
 			"POP PSW\n"
@@ -333,13 +368,13 @@ TEST(CodeGenTests, Integration1) {
 			"LXI B, 0\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 16\n"
+			"LXI H, 14\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 16\n"
+			"LXI H, 14\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
@@ -348,8 +383,8 @@ TEST(CodeGenTests, Integration1) {
 			"POP B\n"
 			"POP B\n"
 			"POP B\n"
-			"MOV A, B\n"
-			"LXI H, 16\n"
+			"MOV A, C\n"
+			"LXI H, 14\n"
 			"DAD SP\n"
 			"MOV M, A\n"
 			"POP PSW\n"
@@ -374,4 +409,514 @@ TEST(CodeGenTests, Integration1) {
 			"POP B\n"
 			"RET\n",
 			oss.str());
-}
\ No newline at end of file
+}
+TEST(CodeGenTests, ByteFrames) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	GlobalParameters::getInstance().byteFrames = true;
+	std::istringstream iss(
+			"int f(int x) {"
+			"   int a, b;"
+			"   b = b + x;"
+			"   a = b;"
+			"   return a;"
+			"}"
+			"int main() {"
+			"   out f(3);"
+			"}"
+	);
+	Translator translator(iss);
+	std::ostringstream oss;
+	translator.startTranslation();
+	translator.generateCode(oss);
+	size_t frame = translator.getSymbolTable().getFrameSize(0);
+	GlobalParameters::getInstance().byteFrames = false;
+	std::string code = oss.str();
+	ASSERT_EQ(3, frame);
+	ASSERT_EQ(5, translator.getSymbolTable()._records[1]._offset);
+	ASSERT_EQ(2, translator.getSymbolTable()._records[2]._offset);
+	ASSERT_EQ(1, translator.getSymbolTable()._records[3]._offset);
+	ASSERT_EQ(0, translator.getSymbolTable()._records[4]._offset);
+	ASSERT_NE(std::string::npos, code.find(
+			"f:\n"
+			"LXI H, -3\n"
+			"DAD SP\n"
+			"SPHL\n"
+			"LXI H, 1\n"
+			"DAD SP\n"
+			"MVI M, 0\n"
+			"\t; (ADD, 3, 1, 4)\n"
+	));
+	ASSERT_NE(std::string::npos, code.find(
+			"LXI H, 7\n"
+			"DAD SP\n"
+			"MOV M, A\n"
+			"LXI H, 3\n"
+			"DAD SP\n"
+			"SPHL\n"
+			"RET\n"
+	));
+	ASSERT_EQ(std::string::npos, code.find("PUSH B\nPUSH B\n\t;"));
+}
+
+TEST(CodeGenTests, PerformanceReport) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	std::istringstream iss(
+			"int main() {"
+			"   int i;"
+			"   for (i = 0; i < 3; ++i) out i;"
+			"}"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	std::ostringstream oss;
+	translator.printPerformanceReport(oss);
+	std::vector<std::string> expected = {
+			"PERFORMANCE REPORT:",
+			std::string(64, '-'),
+			"function main: 90 bytes, frame 4 bytes, 3240 weighted cycles",
+			"\tblock 0: 12 bytes, 66 cycles",
+			"\tblock 1: 19 bytes, 87 cycles, loop depth 1",
+			"\tblock 2: 7 bytes, 34 cycles, loop depth 1",
+			"\tblock 3: 12 bytes, 53 cycles, loop depth 1",
+			"\tblock 4: 3 bytes, 10 cycles, loop depth 1",
+			"\tblock 5: 17 bytes, 80 cycles, loop depth 1",
+			"\tblock 6: 10 bytes, 47 cycles, loop depth 1",
+			"\tblock 7: 10 bytes, 64 cycles",
+			""
+	};
+	ASSERT_EQ(expected, split(oss.str(), '\n'));
+}
+
+TEST(CodeGenTests, SourceMap) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	std::istringstream iss(
+			"int g = 2;\n"
+			"int main() {\n"
+			"   out g;\n"
+			"   out \"hi\";\n"
+			"   if (g > 1) out 1;\n"
+			"}\n"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	std::ostringstream oss;
+	translator.generateMap(oss);
+	std::vector<std::string> expected = {
+			"FUNCTIONS:",
+			"main: 0007H-004DH",
+			"",
+			"LINES:",
+			"main line 3: 000BH-0010H",
+			"main line 4: 0010H-0016H",
+			"main line 5: 0016H-0044H",
+			"main line 6: 0044H-004DH",
+			"",
+			"SYMBOLS:",
+			"var0: 8000H",
+			"str0: 8001H",
+			"@MULT: 0007H",
+			"@PRINT: 0007H",
+			"main: 0007H",
+			"LBL2A: 002AH",
+			"LBL2: 0031H",
+			"LBL0: 0044H",
+			"LBL1: 0044H",
+			""
+	};
+	ASSERT_EQ(expected, split(oss.str(), '\n'));
+}
+
+TEST(CodeGenTests, Profiler) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	std::istringstream iss(
+			"int sq(int x) {\n"
+			"   return x * x;\n"
+			"}\n"
+			"int main() {\n"
+			"   int a, i, s = 0;\n"
+			"   in a;\n"
+			"   for (i = 0; i < a; ++i) s = s + sq(i);\n"
+			"   out s;\n"
+			"   out \"done\";\n"
+			"}\n"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	Profiler profiler(translator.listing());
+	std::istringstream input("4");
+	std::ostringstream output;
+	profiler.run(input, output);
+	ASSERT_EQ("14\ndone\n", output.str());
+	std::ostringstream profile;
+	profiler.printProfile(profile);
+	std::ostringstream folded;
+	profiler.printFoldedStacks(folded);
+	std::vector<std::string> expected = {
+			"FLAT PROFILE:",
+			std::string(64, '-'),
+			"total: 3877 cycles",
+			"function main: 3033 self cycles, 3845 total cycles, 1 calls",
+			"function sq: 812 self cycles, 812 total cycles, 4 calls",
+			"",
+			"LINE PROFILE:",
+			"main line 7: 2752 cycles",
+			"sq line 2: 728 cycles",
+			"main line 10: 104 cycles",
+			"main line 6: 37 cycles",
+			"main line 8: 37 cycles",
+			"main line 9: 27 cycles",
+			"",
+			"CALL GRAPH:",
+			"main -> sq: 4 calls, 812 cycles",
+			"",
+			"ATOM HITS:",
+			"sq 0: 4 (MUL, 1, 1, 2)",
+			"sq 1: 4 (RET,,, 2)",
+			"main 0: 1 (IN,,, 4)",
+			"main 1: 1 (MOV, `0`,, 5)",
+			"main 3: 5 (MOV, `1`,, 7)",
+			"main 4: 5 (LT, 5, 4, 4)",
+			"main 5: 1 (MOV, `0`,, 7)",
+			"main 7: 5 (EQ, 7, `0`, 3)",
+			"main 8: 4 (JMP,,, 2)",
+			"main 10: 4 (ADD, 5, `1`, 5)",
+			"main 11: 4 (JMP,,, 0)",
+			"main 14: 4 (CALL, 0,, 9)",
+			"main 15: 4 (ADD, 6, 9, 8)",
+			"main 16: 4 (MOV, 8,, 6)",
+			"main 17: 4 (JMP,,, 1)",
+			"main 19: 1 (OUT,,, 6)",
+			"main 20: 1 (OUT,,, S0)",
+			"main 21: 1 (RET,,, `0`)",
+			""
+	};
+	ASSERT_EQ(expected, split(profile.str(), '\n'));
+	ASSERT_EQ("main 3033\nmain;sq 812\n", folded.str());
+}
+
+TEST(CodeGenTests, ProfileGuidedLayout) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	std::string source =
+			"int main() {\n"
+			"   int n, i, s = 0;\n"
+			"   in n;\n"
+			"   for (i = 0; i < n; ++i) {\n"
+			"       if (i == 77) {\n"
+			"           out \"seventy seven\";\n"
+			"           out i;\n"
+			"       } else s = s + i;\n"
+			"   }\n"
+			"   out s;\n"
+			"}\n";
+	std::ostringstream profile;
+	std::ostringstream output;
+	size_t cycles;
+	{
+		std::istringstream iss(source);
+		Translator translator(iss);
+		std::ostringstream code;
+		translator.startTranslation();
+		translator.generateCode(code);
+		Profiler profiler(translator.listing());
+		std::istringstream input("20");
+		profiler.run(input, output);
+		profiler.printProfile(profile);
+		cycles = profiler.cycles();
+	}
+	std::istringstream iss(source);
+	Translator translator(iss);
+	std::istringstream profileInput(profile.str());
+	translator.setProfile(Profiler::readAtomHits(profileInput));
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	Profiler profiler(translator.listing());
+	std::istringstream input("20");
+	std::ostringstream layoutOutput;
+	profiler.run(input, layoutOutput);
+	ASSERT_EQ(output.str(), layoutOutput.str());
+	ASSERT_EQ(12074, cycles);
+	ASSERT_EQ(11694, profiler.cycles());
+	// the branch that never ran goes behind the return of main
+	ASSERT_LT(code.str().find("RET\n"), code.str().find("CALL @PRINT"));
+}
+
+TEST(CodeGenTests, ProfileCounters) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	ScopedParameter<bool> profileGenerate(GlobalParameters::getInstance().profileGenerate, true);
+	std::istringstream iss(
+			"int sq(int x) {\n"
+			"   return x * x;\n"
+			"}\n"
+			"int main() {\n"
+			"   int a, i, s = 0;\n"
+			"   in a;\n"
+			"   for (i = 0; i < a; ++i) s = s + sq(i);\n"
+			"   out s;\n"
+			"}\n"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	Profiler profiler(translator.listing());
+	std::istringstream input("4");
+	std::ostringstream output;
+	profiler.run(input, output);
+	ASSERT_EQ("14\n", output.str());
+	std::istringstream dump(profiler.counterDump());
+	std::ostringstream profile;
+	ASSERT_TRUE(Profiler::printCounterProfile(profile, translator.counters(), dump));
+	std::vector<std::string> expected = {
+			"CALL GRAPH:",
+			"main -> sq: 4 calls",
+			"",
+			"ATOM HITS:",
+			"main 0: 1",
+			"main 2: 5",
+			"main 5: 1",
+			"main 6: 5",
+			"main 8: 4",
+			"main 9: 4",
+			"main 12: 4",
+			"main 18: 1",
+			"sq 0: 4",
+			""
+	};
+	ASSERT_EQ(expected, split(profile.str(), '\n'));
+	std::istringstream shortDump(profiler.counterDump().substr(1));
+	std::ostringstream unused;
+	ASSERT_FALSE(Profiler::printCounterProfile(unused, translator.counters(), shortDump));
+}
+
+TEST(CodeGenTests, ProfileCountersMainTailCall) {
+	// main keeps its frame when instrumented, so it gets back from f to write the counters
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	ScopedParameter<int> optimizationLevel(GlobalParameters::getInstance().optimizationLevel, 1);
+	ScopedParameter<bool> profileGenerate(GlobalParameters::getInstance().profileGenerate, true);
+	std::istringstream iss(
+			"int g;\n"
+			"int f() {\n"
+			"   if (g == 0) return 0;\n"
+			"   out g;\n"
+			"   g = g - 1;\n"
+			"   return f() + 1;\n"
+			"}\n"
+			"int main() {\n"
+			"   in g;\n"
+			"   return f();\n"
+			"}\n"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	Profiler profiler(translator.listing());
+	std::istringstream input("3");
+	std::ostringstream output;
+	profiler.run(input, output);
+	ASSERT_EQ("3\n2\n1\n", output.str());
+	ASSERT_FALSE(profiler.counterDump().empty());
+	std::istringstream dump(profiler.counterDump());
+	std::ostringstream profile;
+	ASSERT_TRUE(Profiler::printCounterProfile(profile, translator.counters(), dump));
+	std::vector<std::string> expected = {
+			"CALL GRAPH:",
+			"f -> f: 3 calls",
+			"main -> f: 1 calls",
+			"",
+			"ATOM HITS:",
+			"f 0: 4",
+			"f 1: 1",
+			"f 2: 3",
+			"main 0: 1",
+			""
+	};
+	ASSERT_EQ(expected, split(profile.str(), '\n'));
+}
+
+TEST(CodeGenTests, RstHelpers) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	ScopedParameter<bool> rstHelpers(GlobalParameters::getInstance().rstHelpers, true);
+	std::istringstream iss(
+			"int main() {"
+			"   int a, b;"
+			"   in a;"
+			"   in b;"
+			"   out \"product\";"
+			"   out a * b;"
+			"   out a * a;"
+			"   out a * a * a;"
+			"}"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	// @PRINT has a single call site, a vector would not pay for itself
+	auto lines = split(code.str(), '\n');
+	std::vector<std::string> prolog(lines.begin() + 2, lines.begin() + 10);
+	std::vector<std::string> expected = {
+			"ORG 0",
+			"LXI H, 0",
+			"SPHL",
+			"CALL main",
+			"END",
+			"ORG 8",
+			"JMP @MULT",
+			"@MULT:"
+	};
+	ASSERT_EQ(expected, prolog);
+	ASSERT_EQ(4, std::count(lines.begin(), lines.end(), "RST 1"));
+	ASSERT_EQ(1, std::count(lines.begin(), lines.end(), "CALL @PRINT"));
+	Profiler profiler(translator.listing());
+	std::istringstream input("3 4");
+	std::ostringstream output;
+	profiler.run(input, output);
+	ASSERT_EQ("product\n12\n9\n27\n", output.str());
+}
+
+TEST(CodeGenTests, Z80Target) {
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	ScopedParameter<std::string> target(GlobalParameters::getInstance().target, "z80");
+	std::istringstream iss(
+			"int sq(int x) {"
+			"   return x * x;"
+			"}"
+			"int main() {"
+			"   int i, s;"
+			"   in s;"
+			"   i = 0;"
+			"   while (i < 3) {"
+			"       s = s + sq(i);"
+			"       i = i + 1;"
+			"   }"
+			"   out s;"
+			"   out \"done\";"
+			"}"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	// the frame is addressed through IX, which sits below the return address
+	auto lines = split(code.str(), '\n');
+	auto start = std::find(lines.begin(), lines.end(), "sq:");
+	ASSERT_NE(lines.end(), start);
+	std::vector<std::string> function(start, start + 18);
+	std::vector<std::string> expected = {
+			"sq:",
+			"PUSH IX",
+			"LD IX, 0",
+			"ADD IX, SP",
+			"LD BC, 0",
+			"PUSH BC",
+			"\t; (MUL, 1, 1, 2)",
+			"LD A, (IX+4)",
+			"LD D, A",
+			"LD A, (IX+4)",
+			"CALL @MULT",
+			"LD A, C",
+			"LD (IX-2), A",
+			"\t; (RET,,, 2)",
+			"LD A, (IX-2)",
+			"LD (IX+6), A",
+			"POP BC",
+			"POP IX"
+	};
+	ASSERT_EQ(expected, function);
+	for (const auto& line : lines) {
+		ASSERT_EQ(std::string::npos, line.find("ADD HL, SP")) << line;
+		ASSERT_NE(0, line.rfind("MOV ", 0)) << line;
+		ASSERT_NE(0, line.rfind("JMP ", 0)) << line;
+	}
+	ASSERT_NE(0, std::count(lines.begin(), lines.end(), "JR Z, LBL1"));
+	ASSERT_NE(lines.end(), std::find(lines.begin(), lines.end(), "OTIR"));
+	const auto& z80 = *Target::get("z80");
+	ASSERT_EQ(3, z80.instructionSize("LD A, (IX+4)"));
+	ASSERT_EQ(2, z80.instructionSize("JR Z, LBL1"));
+	ASSERT_EQ(19, z80.instructionCycles("LD (IX-2), A"));
+}
+
+TEST(CodeGenTests, LogicalOperatorsAtEveryLevel) {
+	// && and || give 1 or 0 and skip the right operand once decided, in conditions and values alike
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	const std::string program =
+			"int f(int x) {"
+			"   out \"called\";"
+			"   return x;"
+			"}"
+			"int main() {"
+			"   int a, b, x;"
+			"   in a;"
+			"   b = 1;"
+			"   if (a && b) out 1; else out 0;"
+			"   x = a && b;"
+			"   out x;"
+			"   if ((a && b)) out 1; else out 0;"
+			"   x = a || f(a);"
+			"   out x;"
+			"   if (b == 0 || f(a) > 1) out 5;"
+			"   while (a && b) a = a - 1;"
+			"   out a;"
+			"   for (; b || a; b = 0) out 7;"
+			"}";
+	for (int level = 0; level <= 2; level++) {
+		ScopedParameter<int> optimizationLevel(GlobalParameters::getInstance().optimizationLevel, level);
+		std::istringstream iss(program);
+		Translator translator(iss);
+		std::ostringstream code;
+		translator.startTranslation();
+		translator.generateCode(code);
+		Profiler profiler(translator.listing());
+		std::istringstream input("2");
+		std::ostringstream output;
+		profiler.run(input, output);
+		ASSERT_EQ("1\n1\n1\n1\ncalled\n5\n0\n7\n", output.str()) << "-O" << level;
+	}
+}
+
+TEST(CodeGenTests, Z80SlotAroundCall) {
+	// HL saved over a call still holds the slot address afterwards, so the slot keeps its IX form
+	GlobalParameters::getInstance().enableOperatorFormatter = false;
+	GlobalParameters::getInstance().printAsmHeader = false;
+	ScopedParameter<std::string> target(GlobalParameters::getInstance().target, "z80");
+	std::istringstream iss(
+			"int f(int a, int b, int c) {"
+			"   return a;"
+			"}"
+			"int main() {"
+			"   int n;"
+			"   in n;"
+			"   out f(n, 2, 3);"
+			"}"
+	);
+	Translator translator(iss);
+	std::ostringstream code;
+	translator.startTranslation();
+	translator.generateCode(code);
+	auto lines = split(code.str(), '\n');
+	auto start = std::find(lines.begin(), lines.end(), "main:");
+	ASSERT_NE(lines.end(), start);
+	auto in = std::find(start, lines.end(), "IN A, (0)");
+	ASSERT_NE(lines.end(), in);
+	ASSERT_EQ("LD (IX-2), A", *(in + 1));
+	ASSERT_NE(lines.end(), std::find(in, lines.end(), "PUSH HL"));
+	ASSERT_EQ(lines.end(), std::find(start, lines.end(), "ADD HL, SP"));
+}
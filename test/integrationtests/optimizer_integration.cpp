@@ -0,0 +1,957 @@
+//
+// Created by 6rayWa1cher on 19.10.2026.
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+#include "../../src/include/Translator.h"
+#include "../tools.h"
+#include "../../src/include/GlobalParameters.h"
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "cert-err58-cpp"
+
+class OptimizationLevel {
+private:
+	int _saved;
+	bool _savedForSize;
+public:
+	explicit OptimizationLevel(int level, bool forSize = false)
+			: _saved(GlobalParameters::getInstance().optimizationLevel),
+			  _savedForSize(GlobalParameters::getInstance().optimizeForSize) {
+		GlobalParameters::getInstance().optimizationLevel = level;
+		GlobalParameters::getInstance().optimizeForSize = forSize;
+	}
+
+	~OptimizationLevel() {
+		GlobalParameters::getInstance().optimizationLevel = _saved;
+		GlobalParameters::getInstance().optimizeForSize = _savedForSize;
+	}
+};
+
+std::vector<std::string> getOptimizedAtoms(const std::string& s, int level = 1, bool forSize = false) {
+	OptimizationLevel optimizationLevel(level, forSize);
+	GlobalParameters::getInstance().enableOperatorFormatter = true;
+	std::istringstream iss(s);
+	Translator translator(iss);
+	translator.startTranslation();
+	std::ostringstream oss;
+	translator.printAtoms(oss);
+	std::vector<std::string> out = split(oss.str(), '\n');
+	out.erase(out.end() - 1);
+	return out;
+}
+
+TEST(OptimizerTests, ConstantPropagationUnwrittenGlobal) {
+	std::vector<std::string> expected = {
+			"1\t(MOV, `18`,, 2[!temp1])",
+			"1\t(OUT,,, `18`)",
+			"1\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g = 9;"
+			"int main() {"
+			"   out g * 2;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ConstantPropagationPrunesBranch) {
+	std::vector<std::string> expected = {
+			"1\t(MOV, `5`,, 2[a])",
+			"1\t(OUT,,, S0{less})",
+			"1\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g = 9;"
+			"int main() {"
+			"   int a;"
+			"   a = 5;"
+			"   if (a < g) out \"less\"; else out \"greater\";"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ConstantPropagationKeepsLoopVariables) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(LBL,,, L0)",
+			"0\t(OUT,,, 1[i])",
+			"0\t(ADD, 1[i], `1`, 2[!temp1])",
+			"0\t(MOV, 2[!temp1],, 1[i])",
+			"0\t(LT, 2[!temp1], `3`, L0)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i;"
+			"   i = 0;"
+			"   while (i < 3) {"
+			"       out i;"
+			"       i = i + 1;"
+			"   }"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ConstantPropagationGlobalsClobberedByCall) {
+	std::vector<std::string> expected = {
+			"1\t(MOV, `1`,, 0[g])",
+			"1\t(RET,,, `0`)",
+			"3\t(MOV, `4`,, 0[g])",
+			"3\t(CALL, 1[f],, 4[!temp2])",
+			"3\t(OUT,,, 0[g])",
+			"3\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g;"
+			"int f() {"
+			"   g = 1;"
+			"   if (g == 4) f();"
+			"}"
+			"int main() {"
+			"   g = 4;"
+			"   f();"
+			"   out g;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, BranchFusionIf) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(IN,,, 2[b])",
+			"0\t(LE, 1[a], 2[b], L0)",
+			"0\t(OUT,,, 1[a])",
+			"0\t(LBL,,, L0)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a, b;"
+			"   in a;"
+			"   in b;"
+			"   if ((a > b)) out a;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, BranchFusionFor) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 2[n])",
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(EQ, `0`, 2[n], L1)",
+			"0\t(LBL,,, L0)",
+			"0\t(OUT,,, 1[i])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(NE, 1[i], 2[n], L0)",
+			"0\t(LBL,,, L1)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i, n;"
+			"   in n;"
+			"   for (i = 0; i != n; ++i) out i;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, BranchFusionKeepsStoredResult) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(EQ, 1[a], `0`, 3[!temp1])",
+			"0\t(MOV, 3[!temp1],, 2[x])",
+			"0\t(EQ, 3[!temp1], `0`, L1)",
+			"0\t(OUT,,, 2[x])",
+			"0\t(LBL,,, L1)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a, x;"
+			"   in a;"
+			"   x = a == 0;"
+			"   if (x) out x;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ShortCircuitAnd) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(IN,,, 2[b])",
+			"0\t(GE, 1[a], 2[b], L0)",
+			"0\t(EQ, 2[b], `0`, L0)",
+			"0\t(OUT,,, 1[a])",
+			"0\t(LBL,,, L0)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a, b;"
+			"   in a;"
+			"   in b;"
+			"   if (a < b && b) out a;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ShortCircuitOr) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(IN,,, 2[b])",
+			"0\t(NE, 1[a], `0`, L2)",
+			"0\t(GE, 2[b], `3`, L1)",
+			"0\t(LBL,,, L2)",
+			"0\t(IN,,, 1[a])",
+			"0\t(NE, 1[a], `0`, L2)",
+			"0\t(LT, 2[b], `3`, L2)",
+			"0\t(LBL,,, L1)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a, b;"
+			"   in a;"
+			"   in b;"
+			"   while (a || b < 3) in a;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ShortCircuitMixed) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(EQ, 1[a], `0`, L3)",
+			"0\t(CALL, 0[main],, 2[!temp1])",
+			"0\t(NE, 2[!temp1], `0`, L2)",
+			"0\t(LBL,,, L3)",
+			"0\t(EQ, 1[a], `1`, L0)",
+			"0\t(LBL,,, L2)",
+			"0\t(OUT,,, 1[a])",
+			"0\t(LBL,,, L0)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a;"
+			"   in a;"
+			"   if (a && main() || a != 1) out a;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopRotationWithoutCondition) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(LBL,,, L0)",
+			"0\t(OUT,,, 1[i])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(JMP,,, L0)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i;"
+			"   for (i = 0; ; ++i) out i;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopRotationDuplicatesCallInCondition) {
+	std::vector<std::string> expected = {
+			"0\t(CALL, 0[main],, 1[!temp1])",
+			"0\t(EQ, 1[!temp1], `0`, L1)",
+			"0\t(LBL,,, L0)",
+			"0\t(OUT,,, `1`)",
+			"0\t(CALL, 0[main],, 1[!temp1])",
+			"0\t(NE, 1[!temp1], `0`, L0)",
+			"0\t(LBL,,, L1)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   while (main()) out 1;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopInvariantMultiplicationHoisted) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 2[a])",
+			"0\t(IN,,, 3[b])",
+			"0\t(MOV, `0`,, 4[s])",
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(MUL, 2[a], 3[b], 6[!temp2])",
+			"0\t(LBL,,, L0)",
+			"0\t(ADD, 4[s], 6[!temp2], 5[!temp1])",
+			"0\t(MOV, 5[!temp1],, 4[s])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(LT, 1[i], `10`, L0)",
+			"0\t(OUT,,, 4[s])",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i, a, b, s;"
+			"   in a;"
+			"   in b;"
+			"   s = 0;"
+			"   for (i = 0; i < 10; ++i) s = s + a * b;"
+			"   out s;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopInvariantKeepsGlobalsAcrossCall) {
+	std::vector<std::string> expected = {
+			"1\t(ADD, 0[g], `1`, 2[!temp1])",
+			"1\t(MOV, 2[!temp1],, 0[g])",
+			"1\t(NE, 2[!temp1], `0`, L0)",
+			"1\t(CALL, 1[f],, 3[!temp2])",
+			"1\t(LBL,,, L0)",
+			"1\t(RET,,, `0`)",
+			"4\t(IN,,, 5[s])",
+			"4\t(LE, 5[s], `0`, L5)",
+			"4\t(LBL,,, L4)",
+			"4\t(MUL, 0[g], `2`, 7[!temp4])",
+			"4\t(SUB, 5[s], 7[!temp4], 6[!temp3])",
+			"4\t(MOV, 6[!temp3],, 5[s])",
+			"4\t(CALL, 1[f],, 8[!temp5])",
+			"4\t(GT, 6[!temp3], `0`, L4)",
+			"4\t(LBL,,, L5)",
+			"4\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g;"
+			"int f() {"
+			"   g = g + 1;"
+			"   if (g == 0) f();"
+			"}"
+			"int main() {"
+			"   int s;"
+			"   in s;"
+			"   while (s > 0) {"
+			"       s = s - g * 2;"
+			"       f();"
+			"   }"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopInvariantReport) {
+	OptimizationLevel optimizationLevel(1);
+	std::istringstream iss(
+			"int main() {"
+			"   int i, j, a, s;"
+			"   in a;"
+			"   s = 0;"
+			"   for (i = 0; i < 10; ++i)"
+			"       for (j = 0; j < 10; ++j)"
+			"           s = s + a * 3 + i * 5;"
+			"   out s;"
+			"}"
+	);
+	Translator translator(iss);
+	translator.startTranslation();
+	std::ostringstream oss;
+	translator.printOptimizationReport(oss);
+	std::vector<std::string> out = split(oss.str(), '\n');
+	std::vector<std::string> expected = {
+			"OPTIMIZATION REPORT:",
+			std::string(64, '-'),
+			"scope 0, loop L0: hoisted 1 atom",
+			"scope 0, loop L4: hoisted 2 atoms",
+			"function main: 5 frame slots for 9 locals and temps",
+			""
+	};
+	ASSERT_EQ(expected, out);
+}
+
+TEST(OptimizerTests, StrengthReductionConstantFactor) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `0`,, 2[acc])",
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(MOV, `0`,, 5[!temp3])",
+			"0\t(LBL,,, L0)",
+			"0\t(MOV, 5[!temp3],, 4[!temp2])",
+			"0\t(ADD, 2[acc], 5[!temp3], 3[!temp1])",
+			"0\t(MOV, 3[!temp1],, 2[acc])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(ADD, 5[!temp3], `3`, 5[!temp3])",
+			"0\t(LT, 1[i], `10`, L0)",
+			"0\t(OUT,,, 2[acc])",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i, acc;"
+			"   acc = 0;"
+			"   for (i = 0; i < 10; ++i) acc = acc + i * 3;"
+			"   out acc;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, StrengthReductionInvariantFactor) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 2[k])",
+			"0\t(MOV, `0`,, 3[acc])",
+			"0\t(MOV, `8`,, 1[i])",
+			"0\t(MUL, 2[k], `8`, 7[!temp4])",
+			"0\t(LBL,,, L0)",
+			"0\t(MOV, 7[!temp4],, 6[!temp3])",
+			"0\t(ADD, 3[acc], 7[!temp4], 5[!temp2])",
+			"0\t(MOV, 5[!temp2],, 3[acc])",
+			"0\t(SUB, 1[i], `1`, 4[!temp1])",
+			"0\t(MOV, 4[!temp1],, 1[i])",
+			"0\t(SUB, 7[!temp4], 2[k], 7[!temp4])",
+			"0\t(GT, 4[!temp1], `0`, L0)",
+			"0\t(OUT,,, 3[acc])",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i, k, acc;"
+			"   in k;"
+			"   acc = 0;"
+			"   for (i = 8; i > 0; i = i - 1) acc = acc + k * i;"
+			"   out acc;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopUnrollingFull) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(OUT,,, `0`)",
+			"0\t(MOV, `1`,, 1[i])",
+			"0\t(OUT,,, `1`)",
+			"0\t(MOV, `2`,, 1[i])",
+			"0\t(OUT,,, `2`)",
+			"0\t(MOV, `3`,, 1[i])",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i;"
+			"   for (i = 0; i < 3; ++i) out i;"
+			"}",
+			2
+	));
+}
+
+TEST(OptimizerTests, LoopUnrollingPartial) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 2[s])",
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(LBL,,, L0)",
+			"0\t(ADD, 2[s], 1[i], 3[!temp1])",
+			"0\t(MOV, 3[!temp1],, 2[s])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(ADD, 3[!temp1], 1[i], 3[!temp1])",
+			"0\t(MOV, 3[!temp1],, 2[s])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(LT, 1[i], `46`, L0)",
+			"0\t(OUT,,, 2[s])",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i, s;"
+			"   in s;"
+			"   for (i = 0; i < 46; ++i) s = s + i;"
+			"   out s;"
+			"}",
+			2
+	));
+}
+
+TEST(OptimizerTests, LoopUnrollingDisabledForSize) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `0`,, 1[i])",
+			"0\t(LBL,,, L0)",
+			"0\t(OUT,,, 1[i])",
+			"0\t(ADD, 1[i], `1`, 1[i])",
+			"0\t(LT, 1[i], `3`, L0)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int i;"
+			"   for (i = 0; i < 3; ++i) out i;"
+			"}",
+			2, true
+	));
+}
+
+TEST(OptimizerTests, JumpThreadingIfElseReturns) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(EQ, 1[a], `0`, L0)",
+			"0\t(RET,,, `1`)",
+			"0\t(LBL,,, L0)",
+			"0\t(RET,,, `2`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a;"
+			"   in a;"
+			"   if (a) return 1; else return 2;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, SwitchCollectsCases) {
+	std::vector<std::string> expected = {
+			"0\t(IN,,, 1[a])",
+			"0\t(SWITCH, 1[a], 1:L1 2:L3, L2)",
+			"0\t(LBL,,, L1)",
+			"0\t(OUT,,, `1`)",
+			"0\t(JMP,,, L0)",
+			"0\t(LBL,,, L2)",
+			"0\t(OUT,,, `3`)",
+			"0\t(JMP,,, L0)",
+			"0\t(LBL,,, L3)",
+			"0\t(OUT,,, `2`)",
+			"0\t(LBL,,, L0)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a;"
+			"   in a;"
+			"   switch (a) {"
+			"       case 1: out 1;"
+			"       default: out 3;"
+			"       case 2: out 2;"
+			"   }"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ConstantPropagationFoldsSwitch) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `2`,, 1[a])",
+			"0\t(OUT,,, `2`)",
+			"0\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int main() {"
+			"   int a;"
+			"   a = 2;"
+			"   switch (a) {"
+			"       case 1: out 1;"
+			"       case 2: out 2;"
+			"       default: out 3;"
+			"   }"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ConstantPropagationDisabledByDefault) {
+	std::vector<std::string> expected = {
+			"1\t(MUL, 0[g], `2`, 2[!temp1])",
+			"1\t(OUT,,, 2[!temp1])",
+			"1\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g = 9;"
+			"int main() {"
+			"   out g * 2;"
+			"}",
+			0
+	));
+}
+
+TEST(OptimizerTests, InliningSmallFunction) {
+	std::vector<std::string> expected = {
+			"0\t(LE, 1[a], 2[b], L0)",
+			"0\t(RET,,, 1[a])",
+			"0\t(LBL,,, L0)",
+			"0\t(RET,,, 2[b])",
+			"3\t(IN,,, 4[x])",
+			"3\t(IN,,, 5[y])",
+			"3\t(MOV, 4[x],, 8[!temp3])",
+			"3\t(MOV, 5[y],, 9[!temp4])",
+			"3\t(LE, 4[x], 5[y], L4)",
+			"3\t(MOV, 8[!temp3],, 6[!temp1])",
+			"3\t(JMP,,, L6)",
+			"3\t(LBL,,, L4)",
+			"3\t(MOV, 9[!temp4],, 6[!temp1])",
+			"3\t(LBL,,, L6)",
+			"3\t(OUT,,, 6[!temp1])",
+			"3\t(MOV, 5[y],, 10[!temp5])",
+			"3\t(MOV, `7`,, 11[!temp6])",
+			"3\t(LE, 5[y], `7`, L7)",
+			"3\t(MOV, 10[!temp5],, 7[!temp2])",
+			"3\t(JMP,,, L9)",
+			"3\t(LBL,,, L7)",
+			"3\t(MOV, `7`,, 7[!temp2])",
+			"3\t(LBL,,, L9)",
+			"3\t(OUT,,, 7[!temp2])",
+			"3\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int max(int a, int b) {"
+			"   if (a > b) return a;"
+			"   return b;"
+			"}"
+			"int main() {"
+			"   int x, y;"
+			"   in x;"
+			"   in y;"
+			"   out max(x, y);"
+			"   out max(y, 7);"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, InliningBudgetForSize) {
+	std::vector<std::string> expected = {
+			"0\t(RET,,, 1[a])",
+			"2\t(LE, 3[a], `7`, L0)",
+			"2\t(RET,,, 3[a])",
+			"2\t(LBL,,, L0)",
+			"2\t(RET,,, `7`)",
+			"5\t(IN,,, 6[x])",
+			"5\t(MOV, 6[x],, 9[!temp3])",
+			"5\t(MOV, 6[x],, 8[!temp2])",
+			"5\t(PARAM,,, 8[!temp2])",
+			"5\t(PARAM,,, `7`)",
+			"5\t(CALL, 2[max],, 7[!temp1])",
+			"5\t(OUT,,, 7[!temp1])",
+			"5\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int id(int a) {"
+			"   return a;"
+			"}"
+			"int max(int a, int b) {"
+			"   if (a > b) return a;"
+			"   return b;"
+			"}"
+			"int main() {"
+			"   int x;"
+			"   in x;"
+			"   out max(id(x), 7);"
+			"}",
+			2, true
+	));
+}
+
+TEST(OptimizerTests, TailRecursionBecomesLoop) {
+	std::vector<std::string> expected = {
+			"0\t(LBL,,, L8)",
+			"0\t(NE, 2[b], `0`, L0)",
+			"0\t(RET,,, 1[a])",
+			"0\t(LBL,,, L0)",
+			"0\t(GE, 1[a], 2[b], L4)",
+			"0\t(MOV, 1[a],, 10[!temp5])",
+			"0\t(MOV, 2[b],, 1[a])",
+			"0\t(MOV, 10[!temp5],, 2[b])",
+			"0\t(JMP,,, L8)",
+			"0\t(LBL,,, L4)",
+			"0\t(SUB, 1[a], 2[b], 5[!temp3])",
+			"0\t(MOV, 5[!temp3],, 1[a])",
+			"0\t(JMP,,, L8)",
+			"6\t(IN,,, 7[x])",
+			"6\t(IN,,, 8[y])",
+			"6\t(PARAM,,, 7[x])",
+			"6\t(PARAM,,, 8[y])",
+			"6\t(CALL, 0[gcd],, 9[!temp4])",
+			"6\t(OUT,,, 9[!temp4])",
+			"6\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int gcd(int a, int b) {"
+			"   if (b == 0) return a;"
+			"   if (a < b) return gcd(b, a);"
+			"   return gcd(a - b, b);"
+			"}"
+			"int main() {"
+			"   int x, y;"
+			"   in x;"
+			"   in y;"
+			"   out gcd(x, y);"
+			"}",
+			2, true
+	));
+}
+
+TEST(OptimizerTests, TailCallReusesFrame) {
+	std::vector<std::string> expected = {
+			"0\t(LBL,,, L4)",
+			"0\t(LE, 1[a], `100`, L0)",
+			"0\t(RET,,, 1[a])",
+			"0\t(LBL,,, L0)",
+			"0\t(OUT,,, 1[a])",
+			"0\t(ADD, 1[a], 1[a], 3[!temp2])",
+			"0\t(MOV, 3[!temp2],, 1[a])",
+			"0\t(JMP,,, L4)",
+			"4\t(ADD, 5[a], `1`, 7[!temp4])",
+			"4\t(PARAM,,, 7[!temp4])",
+			"4\t(TAILCALL, 0[g],,)",
+			"8\t(IN,,, 9[x])",
+			"8\t(PARAM,,, 9[x])",
+			"8\t(CALL, 4[f],, 10[!temp5])",
+			"8\t(OUT,,, 10[!temp5])",
+			"8\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g(int a) {"
+			"   if (a > 100) return a;"
+			"   out a;"
+			"   return g(a + a);"
+			"}"
+			"int f(int a) {"
+			"   return g(a + 1);"
+			"}"
+			"int main() {"
+			"   int x;"
+			"   in x;"
+			"   out f(x);"
+			"}",
+			2, true
+	));
+}
+
+TEST(OptimizerTests, DeadFunctionElimination) {
+	OptimizationLevel optimizationLevel(1);
+	std::istringstream iss(
+			"int h;"
+			"int unused() {"
+			"   out \"dead\";"
+			"   h = 1;"
+			"}"
+			"int main() {"
+			"   out \"live\";"
+			"}"
+	);
+	Translator translator(iss);
+	translator.startTranslation();
+	std::ostringstream oss;
+	translator.printOptimizationReport(oss);
+	std::vector<std::string> expected = {
+			"OPTIMIZATION REPORT:",
+			std::string(64, '-'),
+			"function unused: unreachable from main",
+			"removed 28 bytes of unreachable code and data",
+			""
+	};
+	ASSERT_EQ(expected, split(oss.str(), '\n'));
+	std::ostringstream code;
+	translator.generateCode(code);
+	ASSERT_EQ(std::string::npos, code.str().find("unused:"));
+	ASSERT_EQ(std::string::npos, code.str().find("var0"));
+	ASSERT_EQ(std::string::npos, code.str().find("'dead'"));
+	ASSERT_NE(std::string::npos, code.str().find("str1: DB 'live', 0"));
+}
+
+TEST(OptimizerTests, InterproceduralConstantsUniform) {
+	std::vector<std::string> expected = {
+			"0\t(MOV, `0`,, 4[s])",
+			"0\t(MOV, `0`,, 3[i])",
+			"0\t(LBL,,, L0)",
+			"0\t(ADD, 4[s], 1[x], 5[!temp1])",
+			"0\t(MOV, 5[!temp1],, 4[s])",
+			"0\t(ADD, 3[i], `1`, 3[i])",
+			"0\t(LT, 3[i], `4`, L0)",
+			"0\t(RET,,, 4[s])",
+			"6\t(IN,,, 7[a])",
+			"6\t(PARAM,,, 7[a])",
+			"6\t(PARAM,,, `4`)",
+			"6\t(CALL, 0[scale],, 8[!temp2])",
+			"6\t(OUT,,, 8[!temp2])",
+			"6\t(ADD, 7[a], `1`, 10[!temp4])",
+			"6\t(PARAM,,, 10[!temp4])",
+			"6\t(PARAM,,, `4`)",
+			"6\t(CALL, 0[scale],, 9[!temp3])",
+			"6\t(OUT,,, 9[!temp3])",
+			"6\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int scale(int x, int k) {"
+			"   int i, s;"
+			"   s = 0;"
+			"   for (i = 0; i < k; ++i) s = s + x;"
+			"   return s;"
+			"}"
+			"int main() {"
+			"   int a;"
+			"   in a;"
+			"   out scale(a, 4);"
+			"   out scale(a + 1, 4);"
+			"}",
+			2, true
+	));
+}
+
+TEST(OptimizerTests, InterproceduralConstantsSpecialization) {
+	std::string body;
+	for (int i = 0; i < 18; i++) body += "   out v * mode;";
+	auto atoms = getOptimizedAtoms(
+			"int show(int v, int mode) {" + body + "}"
+			"int main() {"
+			"   int a, b, c;"
+			"   in a;"
+			"   in b;"
+			"   in c;"
+			"   show(a, 2);"
+			"   show(b, 2);"
+			"   show(c, 3);"
+			"}",
+			2
+	);
+	auto count = [&atoms](const std::string& part) {
+		return std::count_if(atoms.begin(), atoms.end(), [&part](const std::string& atom) {
+			return atom.find(part) != std::string::npos;
+		});
+	};
+	// the hot tuple (_, 2) gets its own copy, the remaining call passes 3 to the original
+	ASSERT_EQ(2, count("[show@1],,"));
+	ASSERT_EQ(1, count("(CALL, 0[show],,"));
+	ASSERT_EQ(18, count("`2`, "));
+	ASSERT_EQ(18, count("`3`, "));
+	ASSERT_EQ(0, count("[mode]"));
+}
+
+#pragma clang diagnostic pop
+
+TEST(OptimizerTests, RedundantPureCall) {
+	std::vector<std::string> expected = {
+			"0\t(NE, 1[a], `0`, L0)",
+			"0\t(RET,,, 2[b])",
+			"0\t(LBL,,, L0)",
+			"0\t(SUB, 1[a], `1`, 4[!temp2])",
+			"0\t(PARAM,,, 4[!temp2])",
+			"0\t(PARAM,,, 2[b])",
+			"0\t(CALL, 0[dist],, 3[!temp1])",
+			"0\t(ADD, 3[!temp1], `1`, 5[!temp3])",
+			"0\t(RET,,, 5[!temp3])",
+			"6\t(IN,,, 7[a])",
+			"6\t(IN,,, 8[b])",
+			"6\t(PARAM,,, 7[a])",
+			"6\t(PARAM,,, 8[b])",
+			"6\t(CALL, 0[dist],, 9[!temp4])",
+			"6\t(MOV, 9[!temp4],, 11[!temp6])",
+			"6\t(MUL, 9[!temp4], 9[!temp4], 10[!temp5])",
+			"6\t(OUT,,, 10[!temp5])",
+			"6\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int dist(int a, int b) {"
+			"   if (a == 0) return b;"
+			"   return dist(a - 1, b) + 1;"
+			"}"
+			"int main() {"
+			"   int a, b;"
+			"   in a;"
+			"   in b;"
+			"   out dist(a, b) * dist(a, b);"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, LoopInvariantPureCall) {
+	std::vector<std::string> expected = {
+			"0\t(NE, 1[a], `0`, L0)",
+			"0\t(RET,,, 2[b])",
+			"0\t(LBL,,, L0)",
+			"0\t(SUB, 1[a], `1`, 4[!temp2])",
+			"0\t(PARAM,,, 4[!temp2])",
+			"0\t(PARAM,,, 2[b])",
+			"0\t(CALL, 0[dist],, 3[!temp1])",
+			"0\t(ADD, 3[!temp1], `1`, 5[!temp3])",
+			"0\t(RET,,, 5[!temp3])",
+			"6\t(IN,,, 7[a])",
+			"6\t(IN,,, 8[b])",
+			"6\t(MOV, `0`,, 10[s])",
+			"6\t(MOV, `0`,, 9[i])",
+			"6\t(GE, `0`, 8[b], L5)",
+			"6\t(PARAM,,, 7[a])",
+			"6\t(PARAM,,, `3`)",
+			"6\t(CALL, 0[dist],, 12[!temp5])",
+			"6\t(LBL,,, L4)",
+			"6\t(ADD, 10[s], 12[!temp5], 11[!temp4])",
+			"6\t(MOV, 11[!temp4],, 10[s])",
+			"6\t(ADD, 9[i], `1`, 9[i])",
+			"6\t(LT, 9[i], 8[b], L4)",
+			"6\t(LBL,,, L5)",
+			"6\t(OUT,,, 10[s])",
+			"6\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int dist(int a, int b) {"
+			"   if (a == 0) return b;"
+			"   return dist(a - 1, b) + 1;"
+			"}"
+			"int main() {"
+			"   int a, b, i, s;"
+			"   in a;"
+			"   in b;"
+			"   s = 0;"
+			"   for (i = 0; i < b; ++i) s = s + dist(a, 3);"
+			"   out s;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, ConstantPropagationGlobalsKeptAcrossPureCall) {
+	std::vector<std::string> expected = {
+			"1\t(NE, 2[x], `0`, L0)",
+			"1\t(RET,,, `0`)",
+			"1\t(LBL,,, L0)",
+			"1\t(SUB, 2[x], `1`, 4[!temp2])",
+			"1\t(PARAM,,, 4[!temp2])",
+			"1\t(CALL, 1[depth],, 3[!temp1])",
+			"1\t(ADD, 3[!temp1], `1`, 5[!temp3])",
+			"1\t(RET,,, 5[!temp3])",
+			"6\t(IN,,, 7[a])",
+			"6\t(MOV, `3`,, 0[g])",
+			"6\t(PARAM,,, 7[a])",
+			"6\t(CALL, 1[depth],, 8[!temp4])",
+			"6\t(OUT,,, 8[!temp4])",
+			"6\t(OUT,,, `3`)",
+			"6\t(RET,,, `0`)"
+	};
+	ASSERT_EQ(expected, getOptimizedAtoms(
+			"int g;"
+			"int depth(int x) {"
+			"   if (x == 0) return 0;"
+			"   return depth(x - 1) + 1;"
+			"}"
+			"int main() {"
+			"   int a;"
+			"   in a;"
+			"   g = 3;"
+			"   out depth(a);"
+			"   out g;"
+			"}"
+	));
+}
+
+TEST(OptimizerTests, StackSlotColoring) {
+	OptimizationLevel optimizationLevel(1);
+	std::istringstream iss(
+			"int main() {"
+			"   int a, b;"
+			"   in a;"
+			"   out a * 2;"
+			"   in b;"
+			"   out b * 3;"
+			"}"
+	);
+	Translator translator(iss);
+	translator.startTranslation();
+	const auto& symbolTable = translator.getSymbolTable();
+	ASSERT_EQ(1, symbolTable.getM(0));
+	ASSERT_EQ(4, symbolTable.getLocalCount(0));
+	ASSERT_EQ(0, symbolTable._records[1]._offset);
+	ASSERT_EQ(0, symbolTable._records[2]._offset);
+	std::ostringstream code;
+	translator.generateCode(code);
+	ASSERT_NE(std::string::npos, code.str().find("main:\nLXI B, 0\nPUSH B\n\t;"));
+}
@@ -14,8 +14,16 @@
 
 TEST(TranslatorExpressionTests, Grammar1_2) {
 	std::vector<std::string> expected = {
-			"(OR, 0[a], `2`, 2[!temp1])",
-			"(OR, 2[!temp1], 1[b], 3[!temp2])"
+			"(MOV, `1`,, 2[!temp1])",
+			"(NE, 0[a], `0`, L0)",
+			"(NE, `2`, `0`, L0)",
+			"(MOV, `0`,, 2[!temp1])",
+			"(LBL,,, L0)",
+			"(MOV, `1`,, 3[!temp2])",
+			"(NE, 2[!temp1], `0`, L1)",
+			"(NE, 1[b], `0`, L1)",
+			"(MOV, `0`,, 3[!temp2])",
+			"(LBL,,, L1)"
 	};
 	std::vector<std::string> actual = getAtomsExpression("a || 2 || b", {"a", "b"});
 	ASSERT_EQ(expected, actual);
@@ -23,7 +31,11 @@ TEST(TranslatorExpressionTests, Grammar1_2) {
 
 TEST(TranslatorExpressionTests, Grammar1_3_4) {
 	std::vector<std::string> expected = {
-			"(OR, 0[a], `2`, 1[!temp1])"
+			"(MOV, `1`,, 1[!temp1])",
+			"(NE, 0[a], `0`, L0)",
+			"(NE, `2`, `0`, L0)",
+			"(MOV, `0`,, 1[!temp1])",
+			"(LBL,,, L0)"
 	};
 	std::vector<std::string> actual = getAtomsExpression("a || 2", {"a"});
 	ASSERT_EQ(expected, actual);
@@ -31,8 +43,16 @@ TEST(TranslatorExpressionTests, Grammar1_3_4) {
 
 TEST(TranslatorExpressionTests, Grammar1_5) {
 	std::vector<std::string> expected = {
-			"(AND, 0[a], `2`, 2[!temp1])",
-			"(AND, 2[!temp1], 1[b], 3[!temp2])"
+			"(MOV, `0`,, 2[!temp1])",
+			"(EQ, 0[a], `0`, L0)",
+			"(EQ, `2`, `0`, L0)",
+			"(MOV, `1`,, 2[!temp1])",
+			"(LBL,,, L0)",
+			"(MOV, `0`,, 3[!temp2])",
+			"(EQ, 2[!temp1], `0`, L1)",
+			"(EQ, 1[b], `0`, L1)",
+			"(MOV, `1`,, 3[!temp2])",
+			"(LBL,,, L1)"
 	};
 	std::vector<std::string> actual = getAtomsExpression("a && 2 && b", {"a", "b"});
 	ASSERT_EQ(expected, actual);
@@ -40,7 +60,11 @@ TEST(TranslatorExpressionTests, Grammar1_5) {
 
 TEST(TranslatorExpressionTests, Grammar1_6_7) {
 	std::vector<std::string> expected = {
-			"(AND, 0[a], `2`, 1[!temp1])"
+			"(MOV, `0`,, 1[!temp1])",
+			"(EQ, 0[a], `0`, L0)",
+			"(EQ, `2`, `0`, L0)",
+			"(MOV, `1`,, 1[!temp1])",
+			"(LBL,,, L0)"
 	};
 	std::vector<std::string> actual = getAtomsExpression("a && 2", {"a"});
 	ASSERT_EQ(expected, actual);
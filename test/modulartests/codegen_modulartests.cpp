@@ -4,8 +4,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <utility>
+#include "../../src/include/Assembly.h"
 #include "../../src/include/Atoms.h"
+#include "../../src/include/Liveness.h"
+#include "../../src/include/Peephole.h"
 #include "../../src/include/Translator.h"
 #include "../tools.h"
 #include "../../src/include/GlobalParameters.h"
@@ -432,6 +436,31 @@ TEST(CodeGenTests, GeAtomGlobal) {
 	);
 }
 
+TEST(CodeGenTests, GeAtomSharedLabel) {
+	std::istringstream iss;
+	LocalTranslator translator = LocalTranslator(
+			iss,
+			{
+					Variable("a", 42), Variable("b", 12)
+			}
+	);
+	auto label = translator.newLabel();
+	std::shared_ptr<Atom> first = std::make_shared<ConditionalJumpAtom>("GE", translator[0], translator[1], label);
+	std::shared_ptr<Atom> second = std::make_shared<ConditionalJumpAtom>("GT", translator[1], translator[0], label);
+	printAtom(first, translator);
+	ASSERT_EQ(
+			"\t; (GT, 1, 0, 0)\n"
+			"LDA var0\n"
+			"MOV B, A\n"
+			"LDA var1\n"
+			"CMP B\n"
+			"JM LBL0A1\n"
+			"JNZ LBL0\n"
+			"LBL0A1:\n",
+			printAtom(second, translator)
+	);
+}
+
 TEST(CodeGenTests, LeAtomGlobal) {
 	std::istringstream iss;
 	LocalTranslator translator = LocalTranslator(
@@ -455,6 +484,51 @@ TEST(CodeGenTests, LeAtomGlobal) {
 	);
 }
 
+TEST(CodeGenTests, RelationalValueAtomGlobal) {
+	std::istringstream iss;
+	LocalTranslator translator = LocalTranslator(
+			iss,
+			{
+					Variable("a", 42), Variable("b", 12), Variable("c", 13)
+			}
+	);
+	std::shared_ptr<Atom> neAtom = std::make_shared<BinaryOpAtom>(
+			"NE", translator[0], translator[1], translator[2]
+	);
+	ASSERT_EQ(
+			"\t; (NE, 0, 1, 2)\n"
+			"LDA var1\n"
+			"MOV B, A\n"
+			"LDA var0\n"
+			"SUB B\n"
+			"ADI 255\n"
+			"SBB A\n"
+			"ANI 1\n"
+			"STA var2\n",
+			printAtom(neAtom, translator)
+	);
+	std::shared_ptr<Atom> gtAtom = std::make_shared<BinaryOpAtom>(
+			"GT", translator[0], translator[1], translator[2]
+	);
+	ASSERT_EQ(
+			"\t; (GT, 0, 1, 2)\n"
+			"LDA var1\n"
+			"MOV B, A\n"
+			"LDA var0\n"
+			"SUB B\n"
+			"MOV C, A\n"
+			"SUI 1\n"
+			"SBB A\n"
+			"ORA C\n"
+			"RLC\n"
+			"ANI 1\n"
+			"XRI 1\n"
+			"STA var2\n",
+			printAtom(gtAtom, translator)
+	);
+	ASSERT_EQ(std::string::npos, printAtom(gtAtom, translator).find('J'));
+}
+
 TEST(CodeGenTests, JmpAtomGlobal) {
 	std::istringstream iss;
 	LocalTranslator translator = LocalTranslator(iss);
@@ -532,8 +606,8 @@ TEST(CodeGenTests, NoParamArgCallAtomLocal) {
 			"PUSH B\n"
 			"CALL f\n"
 			"POP B\n"
-			"MOV A, B\n"
-			"LXI H, 10\n"
+			"MOV A, C\n"
+			"LXI H, 8\n"
 			"DAD SP\n"
 			"MOV M, A\n"
 			"POP PSW\n"
@@ -563,7 +637,7 @@ TEST(CodeGenTests, NoParamArgCallAtomGlobal) {
 			"PUSH B\n"
 			"CALL f\n"
 			"POP B\n"
-			"MOV A, B\n"
+			"MOV A, C\n"
 			"STA var2\n"
 			"POP PSW\n"
 			"POP H\n"
@@ -600,13 +674,13 @@ TEST(CodeGenTests, ParamCallAtom) {
 			"LXI B, 0\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 16\n"
+			"LXI H, 14\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
 			"PUSH B\n"
 			"LXI B, 0\n"
-			"LXI H, 16\n"
+			"LXI H, 14\n"
 			"DAD SP\n"
 			"MOV A, M\n"
 			"MOV C, A\n"
@@ -615,8 +689,8 @@ TEST(CodeGenTests, ParamCallAtom) {
 			"POP B\n"
 			"POP B\n"
 			"POP B\n"
-			"MOV A, B\n"
-			"LXI H, 10\n"
+			"MOV A, C\n"
+			"LXI H, 8\n"
 			"DAD SP\n"
 			"MOV M, A\n"
 			"POP PSW\n"
@@ -650,4 +724,290 @@ TEST(CodeGenTests, ReturnAtom) {
 	);
 }
 
-#pragma clang diagnostic pop
\ No newline at end of file
+
+TEST(CodeGenTests, SwitchAtomLinear) {
+	std::istringstream iss;
+	LocalTranslator translator = LocalTranslator(
+			iss,
+			{
+					Variable("a", 42)
+			}
+	);
+	auto l0 = translator.newLabel();
+	auto l1 = translator.newLabel();
+	auto l2 = translator.newLabel();
+	std::shared_ptr<Atom> switchAtom = std::make_shared<SwitchAtom>(
+			translator[0], SwitchAtom::Cases{{7, l1}, {-1, l0}, {7, l2}}, l2
+	);
+	ASSERT_EQ(
+			"\t; (SWITCH, 0, 7:1 255:0, 2)\n"
+			"LDA var0\n"
+			"CPI 7\n"
+			"JZ LBL1\n"
+			"CPI 255\n"
+			"JZ LBL0\n"
+			"JMP LBL2\n",
+			printAtom(switchAtom, translator)
+	);
+}
+
+TEST(CodeGenTests, SwitchAtomJumpTable) {
+	std::istringstream iss;
+	LocalTranslator translator = LocalTranslator(
+			iss,
+			{
+					Variable("a", 42)
+			}
+	);
+	SwitchAtom::Cases cases;
+	for (int i = 2; i < 18; i++) {
+		if (i != 7) cases.emplace_back(i, translator.newLabel());
+	}
+	auto def = translator.newLabel();
+	ASSERT_EQ(SwitchAtom::Lowering::jumpTable, SwitchAtom::chooseLowering(cases, false));
+	std::shared_ptr<Atom> switchAtom = std::make_shared<SwitchAtom>(translator[0], cases, def);
+	std::vector<std::string> lines = split(printAtom(switchAtom, translator), '\n');
+	std::vector<std::string> expected = {
+			"LDA var0",
+			"SUI 2",
+			"CPI 16",
+			"JNC LBL15",
+			"LXI H, SWT0",
+			"MOV E, A",
+			"MVI D, 0",
+			"DAD D",
+			"DAD D",
+			"MOV E, M",
+			"INX H",
+			"MOV D, M",
+			"XCHG",
+			"PCHL",
+			"SWT0:"
+	};
+	for (int i = 0; i < 16; i++) {
+		expected.push_back("DW LBL" + std::to_string(i < 5 ? i : i == 5 ? 15 : i - 1));
+	}
+	expected.emplace_back("");
+	ASSERT_EQ(expected, std::vector<std::string>(lines.begin() + 1, lines.end()));
+}
+
+TEST(CodeGenTests, SwitchAtomSearchTree) {
+	std::istringstream iss;
+	LocalTranslator translator = LocalTranslator(
+			iss,
+			{
+					Variable("a", 42)
+			}
+	);
+	SwitchAtom::Cases cases;
+	for (int i = 0; i < 24; i++) {
+		cases.emplace_back(i * 10, translator.newLabel());
+	}
+	auto def = translator.newLabel();
+	ASSERT_EQ(SwitchAtom::Lowering::searchTree, SwitchAtom::chooseLowering(cases, false));
+	std::shared_ptr<Atom> switchAtom = std::make_shared<SwitchAtom>(translator[0], cases, def);
+	std::vector<std::string> lines = split(printAtom(switchAtom, translator), '\n');
+	std::vector<std::string> expected = {
+			"LDA var0",
+			"CPI 120",
+			"JZ LBL12",
+			"JC SWT0L0",
+			"CPI 180",
+			"JZ LBL18",
+			"JC SWT0L1",
+			"CPI 210",
+			"JZ LBL21",
+			"JC SWT0L2",
+			"CPI 220",
+			"JZ LBL22",
+			"CPI 230",
+			"JZ LBL23",
+			"JMP LBL24",
+			"SWT0L2:"
+	};
+	ASSERT_EQ(expected, std::vector<std::string>(lines.begin() + 1, lines.begin() + 17));
+	ASSERT_EQ(24, std::count_if(lines.begin(), lines.end(), [](const std::string& line) {
+		return line.rfind("CPI ", 0) == 0;
+	}));
+}
+
+TEST(CodeGenTests, SwitchAtomLoweringCostModel) {
+	std::istringstream iss;
+	LocalTranslator translator(iss);
+	SwitchAtom::Cases cases;
+	for (int i = 0; i < 3; i++) {
+		cases.emplace_back(i, translator.newLabel());
+	}
+	ASSERT_EQ(SwitchAtom::Lowering::linear, SwitchAtom::chooseLowering(cases, false));
+	for (int i = 3; i < 32; i++) {
+		cases.emplace_back(i, translator.newLabel());
+	}
+	ASSERT_EQ(SwitchAtom::Lowering::jumpTable, SwitchAtom::chooseLowering(cases, false));
+	ASSERT_EQ(SwitchAtom::Lowering::jumpTable, SwitchAtom::chooseLowering(cases, true));
+	cases.emplace_back(-100, translator.newLabel());
+	cases.emplace_back(100, translator.newLabel());
+	ASSERT_EQ(SwitchAtom::Lowering::searchTree, SwitchAtom::chooseLowering(cases, false));
+}
+
+#pragma clang diagnostic pop
+TEST(CodeGenTests, TailCallAtom) {
+	std::istringstream iss;
+	auto p = SymbolTableBuilder()
+			.withFunc("g", 2)
+			.withVar("x", "int", 0, 0)
+			.withVar("y", "int", 0, 0)
+			.withFunc("f", 2)
+			.withVar("a", "int", 0, 3)
+			.withVar("b", "int", 0, 3)
+			.withVar("t", "int", 0, 3)
+			.buildPair();
+	LocalTranslator translator = LocalTranslator(iss, p);
+	std::shared_ptr<Atom> paramAtom = std::make_shared<ParamAtom>(translator[5]);
+	printAtom(paramAtom, translator, 3);
+	std::shared_ptr<Atom> paramAtom1 = std::make_shared<ParamAtom>(translator[6]);
+	printAtom(paramAtom1, translator, 3);
+	std::shared_ptr<Atom> tailCallAtom = std::make_shared<TailCallAtom>(translator[0]);
+	ASSERT_EQ(
+			"\t; (TAILCALL, 0,,)\n"
+			"LXI H, 4\n"
+			"DAD SP\n"
+			"MOV A, M\n"
+			"MOV C, A\n"
+			"PUSH B\n"
+			"LXI H, 2\n"
+			"DAD SP\n"
+			"MOV A, M\n"
+			"MOV C, A\n"
+			"PUSH B\n"
+			"POP B\n"
+			"LXI H, 6\n"
+			"DAD SP\n"
+			"MOV M, C\n"
+			"POP B\n"
+			"LXI H, 6\n"
+			"DAD SP\n"
+			"MOV M, C\n"
+			"POP B\n"
+			"JMP g\n",
+			printAtom(tailCallAtom, translator, 3)
+	);
+	ASSERT_EQ(0, translator.codeGenFuncArgs.size());
+}
+
+TEST(CodeGenTests, AssemblySize) {
+	ASSERT_EQ(0, Assembly::instructionSize("\t; (RET,,, `0`)"));
+	ASSERT_EQ(0, Assembly::instructionSize("LBL3A:"));
+	ASSERT_EQ(0, Assembly::instructionSize("ORG 8000H"));
+	ASSERT_EQ(1, Assembly::instructionSize("MOV M, A"));
+	ASSERT_EQ(2, Assembly::instructionSize("MVI A, 1"));
+	ASSERT_EQ(3, Assembly::instructionSize("LXI H, 0"));
+	ASSERT_EQ(3, Assembly::instructionSize("SWT0: JNC LBL2"));
+	ASSERT_EQ(1, Assembly::instructionSize("var0: DB 0"));
+	ASSERT_EQ(6, Assembly::instructionSize("str0: DB 'a;b:c', 0"));
+	ASSERT_EQ(4, Assembly::instructionSize("DW LBL1, LBL2"));
+	ASSERT_EQ(9, Assembly::size("main:\nLXI B, 0\nPUSH B\nCALL f\nPOP B\nRET\n"));
+}
+
+TEST(CodeGenTests, AssemblyCycles) {
+	ASSERT_EQ(0, Assembly::instructionCycles("\t; (RET,,, `0`)"));
+	ASSERT_EQ(0, Assembly::instructionCycles("LBL3A:"));
+	ASSERT_EQ(5, Assembly::instructionCycles("MOV B, A"));
+	ASSERT_EQ(7, Assembly::instructionCycles("MOV A, M"));
+	ASSERT_EQ(10, Assembly::instructionCycles("MVI M, 0"));
+	ASSERT_EQ(7, Assembly::instructionCycles("CMP M"));
+	ASSERT_EQ(4, Assembly::instructionCycles("CMP B"));
+	ASSERT_EQ(13, Assembly::instructionCycles("STA var0"));
+	ASSERT_EQ(10, Assembly::instructionCycles("SWT0: JNC LBL2"));
+	ASSERT_EQ(0, Assembly::instructionCycles("var0: DB 0"));
+	ASSERT_EQ(10 + 11 + 17 + 10 + 10, Assembly::cycles("main:\nLXI B, 0\nPUSH B\nCALL f\nPOP B\nRET\n"));
+}
+
+TEST(CodeGenTests, Liveness) {
+	std::istringstream iss;
+	auto p = SymbolTableBuilder()
+			.withVar("g", "int")
+			.withFunc("f", 1)
+			.withVar("a", "int", 0, 1)
+			.withVar("x", "int", 0, 1)
+			.withVar("y", "int", 0, 1)
+			.buildPair();
+	LocalTranslator translator = LocalTranslator(iss, p);
+	auto loop = translator.newLabel();
+	std::vector<std::shared_ptr<Atom>> atoms = {
+			std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(0), translator[3]),
+			std::make_shared<LabelAtom>(loop),
+			std::make_shared<BinaryOpAtom>("ADD", translator[3], translator[2], translator[3]),
+			std::make_shared<ConditionalJumpAtom>("LT", translator[3], std::make_shared<NumberOperand>(10), loop),
+			std::make_shared<UnaryOpAtom>("MOV", translator[3], translator[0]),
+			std::make_shared<UnaryOpAtom>("MOV", std::make_shared<NumberOperand>(1), translator[4]),
+			std::make_shared<RetAtom>(std::make_shared<NumberOperand>(0))
+	};
+	ControlFlowGraph graph(atoms);
+	ASSERT_EQ(3, graph.size());
+	Liveness liveness(translator.getSymbolTable(), graph);
+	ASSERT_TRUE(liveness.liveIn(0).test(2));
+	ASSERT_FALSE(liveness.liveIn(0).test(3));
+	ASSERT_TRUE(liveness.liveOut(0, 0).test(3));
+	ASSERT_TRUE(liveness.liveOut(1).test(2));
+	ASSERT_TRUE(liveness.liveOut(1).test(3));
+	ASSERT_FALSE(liveness.liveIn(2).test(0));
+	ASSERT_TRUE(liveness.liveIn(2, 1).test(0));
+	ASSERT_FALSE(liveness.liveOut(2, 1).test(4));
+	ASSERT_FALSE(liveness.liveOut(2).test(2));
+	ASSERT_EQ(1, liveness.liveIn(2, 2).count());
+}
+
+TEST(CodeGenTests, Peephole) {
+	Peephole peephole;
+	ASSERT_EQ(
+			"LXI H, 4\n"
+			"DAD SP\n"
+			"MOV M, A\n"
+			"\t; (MOV, 3,, 5)\n"
+			"LXI H, 2\n"
+			"DAD SP\n"
+			"MOV M, A\n"
+			"MOV B, A\n"
+			"STA var0\n"
+			"JZ LBL2\n"
+			"LBL1A:\n"
+			"LBL1:\n"
+			"PUSH B\n"
+			"POP D\n",
+			peephole.run(
+					"LXI H, 4\n"
+					"DAD SP\n"
+					"MOV M, A\n"
+					"\t; (MOV, 3,, 5)\n"
+					"LXI H, 4\n"
+					"DAD SP\n"
+					"MOV A, M\n"
+					"LXI H, 2\n"
+					"DAD SP\n"
+					"MOV M, A\n"
+					"MOV B, A\n"
+					"MOV A, B\n"
+					"PUSH B\n"
+					"POP B\n"
+					"STA var0\n"
+					"LDA var0\n"
+					"JNZ LBL1A\n"
+					"JMP LBL2\n"
+					"LBL1A:\n"
+					"JMP LBL1\n"
+					"LBL1:\n"
+					"PUSH B\n"
+					"POP D\n"
+			)
+	);
+	std::map<std::string, size_t> hits;
+	for (const auto& rule : peephole.hits()) hits[rule.first] = rule.second;
+	ASSERT_EQ(1, hits["same-address"]);
+	ASSERT_EQ(1, hits["stack-store-load"]);
+	ASSERT_EQ(0, hits["stack-load-store"]);
+	ASSERT_EQ(1, hits["register-round-trip"]);
+	ASSERT_EQ(1, hits["push-pop"]);
+	ASSERT_EQ(1, hits["store-load"]);
+	ASSERT_EQ(1, hits["branch-over-jump"]);
+	ASSERT_EQ(1, hits["jump-to-next"]);
+}